@@ -0,0 +1,650 @@
+// Per-call cost of the wrappers, measured against hand-written natives doing
+// the same work.  Everything runs on the stand-in server (`StandIn/`), so no
+// server is needed; the hook benchmarks need subhook to patch `BenchTarget`.
+//
+//   pawn-natives-bench [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+
+#include <sampgdk/interop.h>
+
+#define PAWN_NATIVES_BATCH
+
+#include "../NativeHook.hpp"
+#include "../NativeFunc.hpp"
+#include "../NativeImport.hpp"
+#include "../NativeCallback.hpp"
+#include "../NativesMain.hpp"
+#include "../NativePool.hpp"
+
+#include "../StandIn/StandIn.hpp"
+
+// Written to by every benchmark so the calls can't be optimised out.
+static volatile cell
+	gSink;
+
+/*
+    88888888888
+    88
+    88
+    88aaaaa  88       88  8b,dPPYba,    ,adPPYba,
+    88"""""  88       88  88P'   `"8a  a8"     ""
+    88       88       88  88       88  8b
+    88       "8a,   ,a88  88       88  "8a,   ,aa
+    88        `"YbbdP'Y8  88       88   `"Ybbd8"'
+*/
+
+struct BenchObject
+{
+	int Value;
+};
+
+// The same, but looked up without exceptions.
+struct BenchFound
+{
+	int Value;
+};
+
+// Kept in a `NativePool`.
+struct BenchPooled
+{
+	int Value;
+};
+
+struct BenchService
+{
+	int Value;
+};
+
+static std::shared_ptr<BenchObject>
+	gObjects[16];
+
+static std::shared_ptr<BenchFound>
+	gFound[16];
+
+static pawn_natives::NativePool<BenchPooled>
+	gPooled;
+
+static std::shared_ptr<BenchService>
+	gService = std::make_shared<BenchService>(BenchService{ 7 });
+
+namespace pawn_natives
+{
+	template <>
+	struct ParamLookup<BenchObject>
+	{
+		static std::shared_ptr<BenchObject> Ref(cell ref)
+		{
+			if (ref < 0 || ref >= 16 || !gObjects[ref])
+				throw ParamCastFailure();
+			return gObjects[ref];
+		}
+	};
+
+	template <>
+	struct ParamLookup<BenchFound>
+	{
+		static std::shared_ptr<BenchFound> TryRef(cell ref)
+		{
+			if (ref < 0 || ref >= 16)
+				return 0;
+			return gFound[ref];
+		}
+
+		static BenchFound * Borrow(cell ref)
+		{
+			if (ref < 0 || ref >= 16)
+				return 0;
+			return gFound[ref].get();
+		}
+	};
+
+	template <>
+	struct ParamLookup<BenchPooled> : NativePoolLookup<BenchPooled, gPooled> {};
+
+	template <>
+	struct ParamInject<BenchService>
+	{
+		static std::shared_ptr<BenchService> Get()
+		{
+			return gService;
+		}
+	};
+}
+
+// `ARG` has a comma in it, which the macros can't take.
+typedef ARG<int, 0>
+	BenchFirst;
+
+PAWN_NATIVE(bench, Bench_Int, int(int a, int b))
+{
+	return a + b;
+}
+
+PAWN_NATIVE(bench, Bench_Const, int(int const a, int const b))
+{
+	return a + b;
+}
+
+PAWN_NATIVE_NOEXCEPT(bench, Bench_Noexcept, int(int a, int b))
+{
+	return a + b;
+}
+
+PAWN_NATIVE(bench, Bench_Float, float(float a, float b))
+{
+	return a * b;
+}
+
+PAWN_NATIVE(bench, Bench_Ptr, int(int * a))
+{
+	return ++*a;
+}
+
+PAWN_NATIVE(bench, Bench_ConstPtr, int(int const * a))
+{
+	return *a;
+}
+
+PAWN_NATIVE(bench, Bench_String, int(std::string const & str))
+{
+	return (int)str.length();
+}
+
+PAWN_NATIVE(bench, Bench_StringView, int(pawn_natives::AmxStringView str))
+{
+	return (int)str.length();
+}
+
+PAWN_NATIVE(bench, Bench_StringOut, bool(std::string * str))
+{
+	*str = "Hello World";
+	return true;
+}
+
+PAWN_NATIVE(bench, Bench_StringOutput, bool(pawn_natives::AmxStringOutput str))
+{
+	str = "Hello World";
+	return true;
+}
+
+PAWN_NATIVE(bench, Bench_Varargs, int(pawn_natives::varargs_t args))
+{
+	int
+		ret = 0;
+	for (int i = 0; i != args->Count; ++i)
+		ret += *args->Params[i];
+	return ret;
+}
+
+// Like a format native whose format string doesn't use every argument.
+PAWN_NATIVE(bench, Bench_VarargsFirst, int(pawn_natives::varargs_t args))
+{
+	return args->Count ? args->Get<int>(0) : 0;
+}
+
+PAWN_NATIVE(bench, Bench_Object, int(std::shared_ptr<BenchObject> obj))
+{
+	return obj->Value;
+}
+
+PAWN_NATIVE(bench, Bench_Found, int(std::shared_ptr<BenchFound> obj))
+{
+	return obj->Value;
+}
+
+PAWN_NATIVE(bench, Bench_Borrow, int(BenchFound & obj))
+{
+	return obj.Value;
+}
+
+PAWN_NATIVE(bench, Bench_Pooled, int(BenchPooled & obj))
+{
+	return obj.Value;
+}
+
+PAWN_NATIVE(bench, Bench_Inject, int(int a, DI<BenchService> svc))
+{
+	return a + svc->Value;
+}
+
+PAWN_NATIVE(bench, Bench_InjectCached, int(int a, DI<BenchService> const & svc))
+{
+	return a + svc->Value;
+}
+
+PAWN_NATIVE(bench, Bench_Arg, int(int a, int b, BenchFirst first))
+{
+	return a + b + *first;
+}
+
+// Also `Bench_EachBatch`, with arrays of both.
+PAWN_NATIVE_BATCH(bench, Bench_Each, int(int a, int b))
+{
+	return a + b;
+}
+
+PAWN_NATIVE(bench, Bench_Span, int(pawn_natives::AmxSpan<cell const> values))
+{
+	int
+		ret = 0;
+	for (cell value : values)
+		ret += value;
+	return ret;
+}
+
+// Hand-written equivalents of the wrapped natives above.
+static cell AMX_NATIVE_CALL Raw_Int(AMX * amx, cell * params)
+{
+	return params[1] + params[2];
+}
+
+static cell AMX_NATIVE_CALL Raw_Float(AMX * amx, cell * params)
+{
+	float
+		ret = amx_ctof(params[1]) * amx_ctof(params[2]);
+	return amx_ftoc(ret);
+}
+
+static cell AMX_NATIVE_CALL Raw_Ptr(AMX * amx, cell * params)
+{
+	cell *
+		addr;
+	amx_GetAddr(amx, params[1], &addr);
+	return ++*addr;
+}
+
+static cell AMX_NATIVE_CALL Raw_String(AMX * amx, cell * params)
+{
+	cell *
+		addr;
+	int
+		len;
+	amx_GetAddr(amx, params[1], &addr);
+	amx_StrLen(addr, &len);
+	char *
+		str = (char *)alloca(len + 1);
+	amx_GetString(str, addr, 0, len + 1);
+	return (cell)strlen(str);
+}
+
+static cell AMX_NATIVE_CALL Raw_StringOut(AMX * amx, cell * params)
+{
+	cell *
+		addr;
+	amx_GetAddr(amx, params[1], &addr);
+	amx_SetString(addr, "Hello World", 0, 0, params[2]);
+	return 1;
+}
+
+static cell AMX_NATIVE_CALL Raw_Varargs(AMX * amx, cell * params)
+{
+	cell
+		ret = 0;
+	cell *
+		addr;
+	for (int i = 1, n = (int)(params[0] / sizeof (cell)); i <= n; ++i)
+	{
+		amx_GetAddr(amx, params[i], &addr);
+		ret += *addr;
+	}
+	return ret;
+}
+
+static cell AMX_NATIVE_CALL Raw_VarargsFirst(AMX * amx, cell * params)
+{
+	cell *
+		addr;
+	if (!params[0])
+		return 0;
+	amx_GetAddr(amx, params[1], &addr);
+	return *addr;
+}
+
+static cell AMX_NATIVE_CALL Raw_Object(AMX * amx, cell * params)
+{
+	if (params[1] < 0 || params[1] >= 16 || !gObjects[params[1]])
+		return 0;
+	return gObjects[params[1]]->Value;
+}
+
+// Trusts the size it is given.
+static cell AMX_NATIVE_CALL Raw_Span(AMX * amx, cell * params)
+{
+	cell *
+		values;
+	if (amx_GetAddr(amx, params[1], &values) != AMX_ERR_NONE)
+		return 0;
+	int
+		ret = 0;
+	for (cell i = 0; i < params[2]; ++i)
+		ret += values[i];
+	return ret;
+}
+
+static cell AMX_NATIVE_CALL Raw_Pooled(AMX * amx, cell * params)
+{
+	BenchPooled *
+		obj = gPooled.Get((uint32_t)params[1]);
+	if (!obj)
+		return 0;
+	return obj->Value;
+}
+
+/*
+    88        88                         88
+    88        88                         88
+    88        88                         88
+    88aaaaaaaa88   ,adPPYba,    ,adPPYba,  88   ,d8
+    88""""""""88  a8"     "8a  a8"     "8a 88 ,a8"
+    88        88  8b       d8  8b       d8 8888[
+    88        88  "8a,   ,a8"  "8a,   ,a8" 88`"Yba,
+    88        88   `"YbbdP"'    `"YbbdP"'  88   `Y8a
+*/
+
+// The "server" native that gets hooked.  The extra work keeps it big enough for
+// subhook to patch.
+static cell AMX_NATIVE_CALL BenchTarget(AMX * amx, cell * params)
+{
+	gSink = params[1];
+	return params[1] * 2 + 1;
+}
+
+// What sampgdk would generate for `BenchTarget`.
+extern "C" int sampgdk_BenchTarget(int value)
+{
+	static AMX_NATIVE
+		native = sampgdk_FindNative("BenchTarget");
+	cell
+		params[] = { 1 * sizeof (cell), value };
+	return (int)sampgdk_CallNative(native, params);
+}
+
+PAWN_HOOK(bench, BenchTarget, int(int value))
+{
+	return BenchTarget(value);
+}
+
+// The script's public functions.
+static cell AMX_NATIVE_CALL BenchPublic(AMX * amx, cell * params)
+{
+	return params[1] + params[2];
+}
+
+PAWN_CALLBACK(bench, OnBenchEvent, int(int a, float b));
+
+/*
+    88888888ba                                       88
+    88      "8b                                      88
+    88      ,8P                                      88
+    88aaaaaa8P'   ,adPPYba,  8b,dPPYba,    ,adPPYba, 88,dPPYba,
+    88""""""8b,  a8P_____88  88P'   `"8a  a8"     "" 88P'    "8a
+    88      `8b  8PP"""""""  88       88  8b         88       88
+    88      a8P  "8b,   ,aa  88       88  "8a,   ,aa 88       88
+    88888888P"    `"Ybbd8"'  88       88   `"Ybbd8"' 88       88
+*/
+
+static long
+	gIterations = 10000000;
+
+template <typename F>
+static double Measure(F const & f)
+{
+	// Warm up the caches and branch predictors first.
+	for (long i = gIterations / 100; i--; )
+		f();
+	auto
+		start = std::chrono::steady_clock::now();
+	for (long i = gIterations; i--; )
+		f();
+	std::chrono::duration<double, std::nano>
+		elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / (double)gIterations;
+}
+
+static void Report(char const * name, double wrapped, double raw)
+{
+	if (raw > 0.0)
+	printf("%-34s %9.2f ns %9.2f ns %7.2fx\n", name, wrapped, raw, wrapped / raw);
+	else
+		printf("%-34s %9.2f ns\n", name, wrapped);
+}
+
+static void Compare(char const * name, AMX * amx, AMX_NATIVE wrapped, AMX_NATIVE raw, cell * params)
+{
+	double
+		a = Measure([&] { gSink = wrapped(amx, params); }),
+		b = raw ? Measure([&] { gSink = raw(amx, params); }) : 0.0;
+	Report(name, a, b);
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc > 1)
+		gIterations = atol(argv[1]);
+	for (int i = 0; i != 16; ++i)
+	{
+		gObjects[i] = std::make_shared<BenchObject>(BenchObject{ i });
+		gFound[i] = std::make_shared<BenchFound>(BenchFound{ i });
+	}
+	cell
+		pooled = 0,
+		stale = 0;
+	for (int i = 0; i != 16; ++i)
+		pooled = gPooled.Emplace(BenchPooled{ i });
+	stale = gPooled.Emplace(BenchPooled{ 16 });
+	gPooled.Remove(stale);
+	// Left empty for the misses.
+	gObjects[15] = 0;
+	gFound[15] = 0;
+
+	// Found in the middle of a gamemode's worth of other publics.
+	std::vector<std::pair<std::string, stand_in::Public>>
+		publics;
+	for (int i = 0; i != 64; ++i)
+		publics.emplace_back("OnBenchPublic" + std::to_string(i), &BenchPublic);
+	publics.emplace(publics.begin() + 32, "OnBenchEvent", &BenchPublic);
+
+	// The server's natives must exist before the plugin loads.
+	stand_in::AddNative("BenchTarget", &BenchTarget);
+	stand_in::Script
+		script({
+			"Bench_Int",
+			"Bench_Const",
+			"Bench_Noexcept",
+			"Bench_Float",
+			"Bench_Ptr",
+			"Bench_ConstPtr",
+			"Bench_String",
+			"Bench_StringView",
+			"Bench_StringOut",
+			"Bench_StringOutput",
+			"Bench_Varargs",
+			"Bench_VarargsFirst",
+			"Bench_Object",
+			"Bench_Found",
+			"Bench_Borrow",
+			"Bench_Pooled",
+			"Bench_Inject",
+			"Bench_InjectCached",
+			"Bench_Arg",
+			"BenchTarget",
+			"GetNativeID",
+			"CallNativeBatch",
+			"Bench_Each",
+			"Bench_EachBatch",
+			"Bench_Span",
+		},
+		publics);
+	AMX *
+		amx = script.GetAMX();
+	script.Load(&pawn_natives::AmxLoad);
+
+	cell
+		value = script.Allot(1),
+		string = script.PushString("Hello World"),
+		output = script.Allot(32),
+		longString,
+		longOutput = script.Allot(256),
+		varargs[24];
+	*script.GetAddr(value) = 42;
+	for (int i = 0; i != 24; ++i)
+	{
+		varargs[i] = script.Allot(1);
+		*script.GetAddr(varargs[i]) = i;
+	}
+	// Chat and command length text.
+	char
+		text[145];
+	for (int i = 0; i != 144; ++i)
+		text[i] = 'a' + i % 26;
+	text[144] = '\0';
+	longString = script.PushString(text);
+	float
+		x = 1.5f,
+		y = 2.5f;
+
+	cell
+		intParams[] = { 2 * sizeof (cell), 3, 4 },
+		floatParams[] = { 2 * sizeof (cell), amx_ftoc(x), amx_ftoc(y) },
+		ptrParams[] = { 1 * sizeof (cell), value },
+		stringParams[] = { 1 * sizeof (cell), string },
+		outputParams[] = { 2 * sizeof (cell), output, 32 },
+		longStringParams[] = { 1 * sizeof (cell), longString },
+		longOutputParams[] = { 2 * sizeof (cell), longOutput, 256 },
+		varargsParams[] = { 8 * sizeof (cell), varargs[0], varargs[1], varargs[2], varargs[3], varargs[4], varargs[5], varargs[6], varargs[7] },
+		manyVarargsParams[25],
+		objectParams[] = { 1 * sizeof (cell), 5 },
+		missParams[] = { 1 * sizeof (cell), 15 },
+		pooledParams[] = { 1 * sizeof (cell), pooled },
+		staleParams[] = { 1 * sizeof (cell), stale },
+		hookParams[] = { 1 * sizeof (cell), 11 };
+
+	// More than fit in `varargs_t`'s own buffer.
+	manyVarargsParams[0] = 24 * sizeof (cell);
+	for (int i = 0; i != 24; ++i)
+		manyVarargsParams[i + 1] = varargs[i];
+
+	printf("%-34s %12s %12s %8s\n", "", "wrapped", "raw", "ratio");
+	Compare("int", amx, script.GetNative(0), &Raw_Int, intParams);
+	Compare("int const", amx, script.GetNative(1), &Raw_Int, intParams);
+	Compare("int (noexcept)", amx, script.GetNative(2), &Raw_Int, intParams);
+	Compare("float", amx, script.GetNative(3), &Raw_Float, floatParams);
+	Compare("int *", amx, script.GetNative(4), &Raw_Ptr, ptrParams);
+	Compare("int const *", amx, script.GetNative(5), &Raw_Ptr, ptrParams);
+	Compare("std::string const &", amx, script.GetNative(6), &Raw_String, stringParams);
+	Compare("std::string const & (144)", amx, script.GetNative(6), &Raw_String, longStringParams);
+	Compare("AmxStringView", amx, script.GetNative(7), &Raw_String, stringParams);
+	Compare("AmxStringView (144)", amx, script.GetNative(7), &Raw_String, longStringParams);
+	Compare("std::string *", amx, script.GetNative(8), &Raw_StringOut, outputParams);
+	Compare("std::string * (256)", amx, script.GetNative(8), &Raw_StringOut, longOutputParams);
+	Compare("AmxStringOutput", amx, script.GetNative(9), &Raw_StringOut, outputParams);
+	Compare("AmxStringOutput (256)", amx, script.GetNative(9), &Raw_StringOut, longOutputParams);
+	Compare("varargs_t (8)", amx, script.GetNative(10), &Raw_Varargs, varargsParams);
+	Compare("varargs_t (24)", amx, script.GetNative(10), &Raw_Varargs, manyVarargsParams);
+	Compare("varargs_t (8, first only)", amx, script.GetNative(11), &Raw_VarargsFirst, varargsParams);
+	Compare("std::shared_ptr<T>", amx, script.GetNative(12), &Raw_Object, objectParams);
+	Compare("std::shared_ptr<T> (TryRef)", amx, script.GetNative(13), &Raw_Object, objectParams);
+	Compare("T & (Borrow)", amx, script.GetNative(14), &Raw_Object, objectParams);
+	Compare("T & (NativePool)", amx, script.GetNative(15), &Raw_Pooled, pooledParams);
+	// Looking up an object that doesn't exist, by throwing `ParamCastFailure`
+	// from `Ref` and by returning nothing from `TryRef`.
+	Compare("std::shared_ptr<T> miss (Ref)", amx, script.GetNative(12), &Raw_Object, missParams);
+	Compare("std::shared_ptr<T> miss (TryRef)", amx, script.GetNative(13), &Raw_Object, missParams);
+	Compare("T & miss (Borrow)", amx, script.GetNative(14), &Raw_Object, missParams);
+	Compare("T & stale ID (NativePool)", amx, script.GetNative(15), &Raw_Pooled, staleParams);
+	Compare("DI<T>", amx, script.GetNative(16), &Raw_Int, intParams);
+	Compare("DI<T> const & (cached)", amx, script.GetNative(17), &Raw_Int, intParams);
+	Compare("ARG<T, N>", amx, script.GetNative(18), &Raw_Int, intParams);
+
+	// Through the script's native table, which is the patched `BenchTarget`
+	// when subhook could install the hook.
+	Compare("hook (from Pawn)", amx, script.GetNative(19), 0, hookParams);
+	Report("hook (from C++)", Measure([] { gSink = bench::BenchTarget(11); }), 0.0);
+	Report("hook original", Measure([] { gSink = (*bench::BenchTarget)(11); }), 0.0);
+
+	// Calling in to the script from C++, with the index found when the
+	// script was loaded or by name each time.
+	Report("callback", Measure([&] { gSink = bench::OnBenchEvent.Call(amx, 3, x); }), Measure([&]
+	{
+		int
+			index;
+		cell
+			ret = 0;
+		if (amx_FindPublic(amx, "OnBenchEvent", &index) == AMX_ERR_NONE)
+		{
+			amx_Push(amx, amx_ftoc(x));
+			amx_Push(amx, 3);
+			amx_Exec(amx, &ret, index);
+		}
+		gSink = ret;
+	}));
+
+	// The `int` native 64 times in one call, and without a batch.  The stand-in
+	// has no `SYSREQ`, so this is just the cost of the batch on top of each.
+	cell
+		name = script.PushString("Bench_Int"),
+		idParams[] = { 1 * sizeof (cell), name },
+		batch = script.Allot(64 * 4),
+		results = script.Allot(64);
+	cell
+		id = script.Call(20, idParams);
+	for (int i = 0; i != 64; ++i)
+	{
+		cell *
+			entry = script.GetAddr(batch) + i * 4;
+		entry[0] = id;
+		entry[1] = 2;
+		entry[2] = 3;
+		entry[3] = i;
+	}
+	cell
+		batchParams[] = { 4 * sizeof (cell), batch, 64 * 4, results, 64 };
+	AMX_NATIVE
+		intNative = script.GetNative(0),
+		batchNative = script.GetNative(21);
+	Report("batch (64, per call)", Measure([&] { gSink = batchNative(amx, batchParams); }) / 64, Measure([&]
+	{
+		for (int i = 0; i != 64; ++i)
+			gSink = intNative(amx, intParams);
+	}) / 64);
+
+	// The same again, but with one array for each parameter.
+	cell
+		as = script.Allot(64),
+		bs = script.Allot(64);
+	for (int i = 0; i != 64; ++i)
+	{
+		script.GetAddr(as)[i] = 3;
+		script.GetAddr(bs)[i] = i;
+	}
+	cell
+		eachParams[] = { 3 * sizeof (cell), as, bs, 64 };
+	AMX_NATIVE
+		eachNative = script.GetNative(22),
+		eachBatchNative = script.GetNative(23);
+	Report("PAWN_NATIVE_BATCH (64, per call)", Measure([&] { gSink = eachBatchNative(amx, eachParams); }) / 64, Measure([&]
+	{
+		for (int i = 0; i != 64; ++i)
+			gSink = eachNative(amx, intParams);
+	}) / 64);
+
+	cell
+		spanParams[] = { 2 * sizeof (cell), bs, 64 };
+	Compare("AmxSpan<cell const> (64)", amx, script.GetNative(24), &Raw_Span, spanParams);
+
+	// Per-script data, as a native would find it.
+	Report("NativeScript::Get", Measure([&] { gSink = ++pawn_natives::NativeScript::Find(amx)->Get<BenchPooled>().Value; }), 0.0);
+
+	// Registering the natives with a script, as done once per script load.
+	long
+		iterations = gIterations;
+	gIterations /= 100;
+	Report("AmxLoad", Measure([&] { script.Unbind(); pawn_natives::AmxLoad(amx); }), 0.0);
+	gIterations = iterations;
+	script.Unload(&pawn_natives::AmxUnload);
+	return 0;
+}
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <memory>
 #include <optional>
+#include <type_traits>
 #include <amx/amx.h>
 
+#include "NativeErrors.hpp"
+#include "NativeSpan.hpp"
+#include "NativeString.hpp"
+
 // This is in the global namespace, not the pawn_natives namespace.
 template <typename T>
 class DI : public std::shared_ptr<T>
@@ -115,21 +121,6 @@ private:
 
 namespace pawn_natives
 {
-	// This is for any casts that can't go on, but where this is somewhat expected.  For example, a
-	// cast to a player when there is no player.
-	class ParamCastFailure : public std::invalid_argument
-	{
-	public:
-		explicit ParamCastFailure() : std::invalid_argument("ParamCast failed acceptably.") {}
-	};
-
-	// This is for true cast errors.
-	class ParamCastError : public std::invalid_argument
-	{
-	public:
-		explicit ParamCastError() : std::invalid_argument("ParamCast had an exception.") {}
-	};
-
 	template <typename T, typename = void>
 	struct ParamLookup
 	{
@@ -149,6 +140,69 @@ namespace pawn_natives
 	{
 	};
 
+	// `DI<T> const &` parameters get their service from here, so
+	// `ParamInject<T>::Get` is only called the first time, not on every call,
+	// and no `shared_ptr` is copied.  Call `Reset` when the service is replaced
+	// (but not from a native using it) and the next call gets it again.
+	template <typename T>
+	class InjectCache
+	{
+	public:
+		static DI<T> const & Get()
+		{
+			if (!cached_)
+				cached_ = ParamInject<T>::Get();
+			return cached_;
+		}
+
+		static void Reset()
+		{
+			cached_.reset();
+		}
+
+	private:
+		static inline DI<T>
+			cached_ = std::shared_ptr<T>();
+	};
+
+	// Object lookups provide `Ref`, which throws `ParamCastFailure` when there
+	// is no such object.  They may also provide `TryRef`, which returns an
+	// empty pointer instead.  Natives and hooks check for this and skip the
+	// call, returning `0`, without any exception being thrown - much cheaper
+	// when scripts often pass IDs that don't exist.
+	template <typename T, typename = void>
+	struct HasRef : std::false_type
+	{
+	};
+
+	template <typename T>
+	struct HasRef<T, std::void_t<decltype(ParamLookup<T>::Ref(0))>> : std::true_type
+	{
+	};
+
+	template <typename T, typename = void>
+	struct HasTryRef : std::false_type
+	{
+	};
+
+	template <typename T>
+	struct HasTryRef<T, std::void_t<decltype(ParamLookup<T>::TryRef(0))>> : std::true_type
+	{
+	};
+
+	// Lookups may also provide `Borrow`, returning a plain pointer (`NULL` if
+	// there is no such object) for `T &` parameters.  The object need only live
+	// until the native returns, so no `shared_ptr` is copied.
+	template <typename T, typename = void>
+	struct HasBorrow : std::false_type
+	{
+	};
+
+	template <typename T>
+	struct HasBorrow<T, std::void_t<decltype(ParamLookup<T>::Borrow(0))>> : std::true_type
+	{
+	};
+
 	template <>
 	struct ParamLookup<float>
 	{
@@ -163,11 +217,48 @@ namespace pawn_natives
 		}
 	};
 
+	// Convert a native's return value to a cell.  Copying the bytes with
+	// `*(cell *)&ret` would read past the end of smaller types like `bool`.
+	// Anything else - structs and so on - needs its own specialisation.
+	template <typename T>
+	struct ReturnCast
+	{
+		static_assert(std::is_convertible<T, cell>::value || std::is_enum<T>::value || std::is_pointer<T>::value, "Natives can only return numbers, enums, and pointers, unless `ReturnCast<T>` is specialised.");
+
+		static cell Get(T ret)
+		{
+			if constexpr (std::is_pointer<T>::value)
+				// Addresses fit in a cell on the 32-bit server.
+				return (cell)reinterpret_cast<intptr_t>(ret);
+			else
+				return (cell)ret;
+		}
+	};
+
+	template <>
+	struct ReturnCast<float>
+	{
+		static cell Get(float ret)
+		{
+			return amx_ftoc(ret);
+		}
+	};
+
+	// Objects are returned to Pawn as their IDs.
+	template <>
+	struct ReturnCast<ID32Provider const &>
+	{
+		static cell Get(ID32Provider const & ret)
+		{
+			return (cell)ret.ID();
+		}
+	};
+
 	template <typename T>
 	class ParamCast
 	{
 	public:
-		ParamCast(AMX * amx, cell * params, int idx)
+		ParamCast(AMX *, cell * params, int idx)
 		:
 			value_(ParamLookup<T>::Val(params[idx]))
 		{
@@ -331,9 +422,9 @@ namespace pawn_natives
 	class ParamCast<std::shared_ptr<T>>
 	{
 	public:
-		ParamCast(AMX * amx, cell * params, int idx)
+		ParamCast(AMX *, cell * params, int idx)
 		:
-			value_(ParamLookup<T>::Ref(params[idx]))
+			value_(Lookup(params[idx]))
 		{
 		}
 
@@ -352,13 +443,100 @@ namespace pawn_natives
 			return value_;
 		}
 
+		// False when `TryRef` found nothing.
+		bool Valid() const
+		{
+			return !HasTryRef<T>::value || value_;
+		}
+
+		static constexpr int Size = 1;
+
+	private:
+		static std::shared_ptr<T> Lookup(cell ref)
+		{
+			if constexpr (HasTryRef<T>::value)
+				return ParamLookup<T>::TryRef(ref);
+			else
+				return ParamLookup<T>::Ref(ref);
+		}
+
+		std::shared_ptr<T>
+			value_;
+	};
+
+	// An object used only during the call.  With `ParamLookup<T>::Borrow` this
+	// is just a pointer - no reference counting at all.  Otherwise it is found
+	// with `TryRef` or `Ref`, and that `shared_ptr` is held until the native
+	// returns.
+	template <typename T>
+	class ParamCast<T &>
+	{
+	public:
+		ParamCast(AMX *, cell * params, int idx)
+		:
+			held_(),
+			value_(Lookup(params[idx], held_))
+		{
+		}
+
+		~ParamCast()
+		{
+			// Some versions may need to write data back here, but not this one.
+		}
+
+		ParamCast(ParamCast<T &> const &) = delete;
+		ParamCast(ParamCast<T &> &&) = delete;
+
+		operator T &() const
+		{
+			return *value_;
+		}
+
+		bool Valid() const
+		{
+			return value_ != 0;
+		}
+
 		static constexpr int Size = 1;
 
 	private:
+		static T * Lookup(cell ref, std::shared_ptr<T> & held)
+		{
+			if constexpr (HasBorrow<T>::value)
+			{
+				return ParamLookup<T>::Borrow(ref);
+			}
+			else if constexpr (HasTryRef<T>::value)
+			{
+				held = ParamLookup<T>::TryRef(ref);
+				return held.get();
+			}
+			else
+			{
+				held = ParamLookup<T>::Ref(ref);
+				return held.get();
+			}
+		}
+
+		// Always empty with `Borrow`.
 		std::shared_ptr<T>
+			held_;
+
+		T *
 			value_;
 	};
 
+	template <typename T>
+	class ParamCast<T const &> : public ParamCast<T &>
+	{
+	public:
+		ParamCast(AMX * amx, cell * params, int idx)
+		:
+			ParamCast<T &>(amx, params, idx)
+		{
+		}
+	};
+
 	//template <typename T>
 	//class ParamCast<std::optional<T &>>
 	//{
@@ -490,6 +668,16 @@ namespace pawn_natives
 			if (len_)
 			{
 				amx_GetAddr(amx, params[idx], &addr_);
+				if ((ucell)*addr_ <= UNPACKEDMAX)
+				{
+					// Unpacked, which is nearly always true, so convert it
+					// straight in to the string.
+					size_t
+						len = StrLenCells(addr_, len_ - 1);
+					value_.resize(len);
+					NarrowCells(&value_[0], addr_, len);
+					return;
+				}
 #ifdef _WIN32
 				char * src = (char *)_malloca(len_);
 				amx_GetString(src, addr_, 0, len_);
@@ -512,7 +700,12 @@ namespace pawn_natives
 		{
 			// This is the only version that actually needs to write data back.
 			if (addr_)
-				amx_SetString(addr_, value_.c_str(), 0, 0, len_);
+			{
+				size_t
+					len = value_.length() < (size_t)len_ ? value_.length() : (size_t)len_ - 1;
+				WidenChars(addr_, value_.data(), len);
+				addr_[len] = 0;
+			}
 		}
 
 		ParamCast(ParamCast<std::string *> const &) = delete;
@@ -550,6 +743,14 @@ namespace pawn_natives
 			int
 				len;
 			amx_GetAddr(amx, params[idx], &addr);
+			if ((ucell)*addr <= UNPACKEDMAX)
+			{
+				size_t
+					length = StrLenCells(addr);
+				value_.resize(length);
+				NarrowCells(&value_[0], addr, length);
+				return;
+			}
 			amx_StrLen(addr, &len);
 			if (len)
 			{
@@ -588,6 +789,243 @@ namespace pawn_natives
 			value_;
 	};
 
+	template <>
+	class ParamCast<AmxStringView>
+	{
+	public:
+		ParamCast(AMX * amx, cell * params, int idx)
+		{
+			// No copies at all - the view reads straight from the AMX.
+			cell *
+				addr;
+			amx_GetAddr(amx, params[idx], &addr);
+			value_ = AmxStringView(addr);
+		}
+
+		~ParamCast()
+		{
+			// Some versions may need to write data back here, but not this one.
+		}
+
+		ParamCast(ParamCast<AmxStringView> const &) = delete;
+		ParamCast(ParamCast<AmxStringView> &&) = delete;
+
+		operator AmxStringView() const
+		{
+			return value_;
+		}
+
+		static constexpr int Size = 1;
+
+	private:
+		AmxStringView
+			value_;
+	};
+
+	template <>
+	class ParamCast<AmxStringView const> : public ParamCast<AmxStringView>
+	{
+	public:
+		ParamCast(AMX * amx, cell * params, int idx)
+		:
+			ParamCast<AmxStringView>(amx, params, idx)
+		{
+			// The view is always read-only, so this is the same.
+		}
+	};
+
+	template <>
+	class ParamCast<AmxStringOutput>
+	{
+	public:
+		ParamCast(AMX * amx, cell * params, int idx)
+		:
+			valid_(true)
+		{
+			// Like `std::string *`, the buffer is followed by its size.  The
+			// whole buffer must be in the script, since it is written to.
+			cell
+				len = params[idx + 1];
+			if (len)
+			{
+				cell *
+					addr = GetAmxArray(amx, params[idx], len);
+				valid_ = addr != 0;
+				if (valid_)
+					value_ = AmxStringOutput(addr, (size_t)len);
+			}
+		}
+
+		~ParamCast()
+		{
+			// Everything was already written straight in to the AMX.
+		}
+
+		ParamCast(ParamCast<AmxStringOutput> const &) = delete;
+		ParamCast(ParamCast<AmxStringOutput> &&) = delete;
+
+		operator AmxStringOutput() const
+		{
+			return value_;
+		}
+
+		// False for a negative size or a buffer outside the script, which
+		// skips the native without throwing.
+		bool Valid() const
+		{
+			return valid_;
+		}
+
+		static constexpr int Size = 2;
+
+	private:
+		bool
+			valid_;
+
+		AmxStringOutput
+			value_;
+	};
+
+	template <typename T>
+	class ParamCast<AmxSpan<T>>
+	{
+	public:
+		ParamCast(AMX * amx, cell * params, int idx)
+		:
+			valid_(true)
+		{
+			// Like `AmxStringOutput`, the array is followed by its size, and the
+			// whole array is checked once here instead of on every access.
+			cell
+				len = params[idx + 1];
+			if (len)
+			{
+				cell *
+					addr = GetAmxArray(amx, params[idx], len);
+				valid_ = addr != 0;
+				if (valid_)
+					value_ = AmxSpan<T>(reinterpret_cast<T *>(addr), (size_t)len);
+			}
+		}
+
+		~ParamCast()
+		{
+			// Everything was already written straight in to the AMX.
+		}
+
+		ParamCast(ParamCast<AmxSpan<T>> const &) = delete;
+		ParamCast(ParamCast<AmxSpan<T>> &&) = delete;
+
+		operator AmxSpan<T>() const
+		{
+			return value_;
+		}
+
+		// False for a negative size or an array outside the script, which
+		// skips the native without throwing.
+		bool Valid() const
+		{
+			return valid_;
+		}
+
+		static constexpr int Size = 2;
+
+	private:
+		bool
+			valid_;
+
+		AmxSpan<T>
+			value_;
+	};
+
+	// Whether a parameter's cast can never throw, so it may be used in a
+	// `PAWN_NATIVE_NOEXCEPT` native: numbers, enums, pointers to numbers, the
+	// string and array views (which skip the native when they are bad), and
+	// objects whose lookup has `TryRef` or `Borrow`.  Specialise it for your
+	// own `ParamCast`s that can't throw.
+	template <typename T>
+	struct ParamNoexcept : std::bool_constant<std::is_arithmetic<T>::value || std::is_enum<T>::value>
+	{
+	};
+
+	template <typename T>
+	struct ParamNoexcept<T *> : std::bool_constant<std::is_arithmetic<std::remove_const_t<T>>::value>
+	{
+	};
+
+	template <typename T>
+	struct ParamNoexcept<std::shared_ptr<T>> : HasTryRef<T>
+	{
+	};
+
+	template <typename T>
+	struct ParamNoexcept<T &> : std::bool_constant<HasBorrow<std::remove_const_t<T>>::value || HasTryRef<std::remove_const_t<T>>::value>
+	{
+	};
+
+	template <>
+	struct ParamNoexcept<AmxStringView> : std::true_type
+	{
+	};
+
+	template <>
+	struct ParamNoexcept<AmxStringOutput> : std::true_type
+	{
+	};
+
+	template <typename T>
+	struct ParamNoexcept<AmxSpan<T>> : std::true_type
+	{
+	};
+
+	// For a whole signature, as given to `PAWN_NATIVE_NOEXCEPT`.
+	template <typename F>
+	struct ParamsNoexcept
+	{
+	};
+
+	template <typename RET, typename ... TS>
+	struct ParamsNoexcept<RET(TS ...)> : std::bool_constant<(ParamNoexcept<TS>::value && ...)>
+	{
+	};
+
+	// Whether a parameter was read, for the casts that can fail without
+	// throwing.  The rest always succeed (or throw).
+	template <typename T>
+	inline auto ParamValid(T const & cast, int)
+		-> decltype(cast.Valid())
+	{
+		return cast.Valid();
+	}
+
+	template <typename T>
+	inline bool ParamValid(T const &, long)
+	{
+		return true;
+	}
+
+	template <typename ... TS>
+	inline bool ParamsValid(TS const & ... casts)
+	{
+		return (ParamValid(casts, 0) && ...);
+	}
+
+	// Call a native and convert its return to a cell.
+	template <class F, typename ... NS>
+	inline cell ParamInvoke(F that, NS &&... vs)
+	{
+		typedef decltype((*that)(std::forward<NS>(vs)...)) RET;
+		if constexpr (std::is_void_v<RET>)
+		{
+			(*that)(std::forward<NS>(vs)...);
+			return 0;
+		}
+		else
+		{
+			return ReturnCast<RET>::Get((*that)(std::forward<NS>(vs)...));
+		}
+	}
+
 	template <size_t N, typename ... TS>
 	struct ParamArray {};
 
@@ -600,6 +1038,12 @@ namespace pawn_natives
 		{
 			return ParamArray<N - 1, TS ...>::Call(that, amx, params, prev + ParamCast<T>::Size, std::forward<NS>(vs)..., ParamCast<T>(amx, params, prev));
 		}
+
+		template <class F, typename ... NS>
+		static inline bool TryCall(F that, AMX * amx, cell * params, cell & ret, size_t prev, NS &&... vs)
+		{
+			return ParamArray<N - 1, TS ...>::TryCall(that, amx, params, ret, prev + ParamCast<T>::Size, std::forward<NS>(vs)..., ParamCast<T>(amx, params, prev));
+		}
 	};
 
 	template <>
@@ -611,6 +1055,17 @@ namespace pawn_natives
 		{
 			return (*that)(std::forward<NS>(vs)...);
 		}
+
+		// Only call the native if every parameter was read, otherwise leave
+		// `ret` alone and return `false`.
+		template <class F, typename ... NS>
+		static inline bool TryCall(F that, AMX *, cell *, cell & ret, size_t, NS &&... vs)
+		{
+			if (!ParamsValid(vs ...))
+				return false;
+			ret = ParamInvoke(that, std::forward<NS>(vs)...);
+			return true;
+		}
 	};
 
 	template <typename ... TS>
@@ -631,6 +1086,12 @@ namespace pawn_natives
 		{
 			return ParamArray<sizeof... (TS) + 1, T, TS ...>::Call(that, amx, params, 1);
 		}
+
+		template <class F>
+		static inline bool TryCall(F that, AMX * amx, cell * params, cell & ret)
+		{
+			return ParamArray<sizeof... (TS) + 1, T, TS ...>::TryCall(that, amx, params, ret, 1);
+		}
 	};
 
 	template <>
@@ -647,6 +1108,13 @@ namespace pawn_natives
 		{
 			return (*that)();
 		}
+
+		template <class F>
+		static inline bool TryCall(F that, AMX *, cell *, cell & ret)
+		{
+			ret = ParamInvoke(that);
+			return true;
+		}
 	};
 
 	/*
@@ -680,8 +1148,28 @@ namespace pawn_natives
 	class ParamCast<DI<T> const&>
 	{
 	public:
-		ParamCast(AMX*, cell*, int) = delete;
-		ParamCast() = delete;
+		ParamCast(AMX*, cell*, int)
+		:
+			value_(InjectCache<T>::Get())
+		{
+		}
+
+		~ParamCast()
+		{
+		}
+
+		operator DI<T> const &() const
+		{
+			return value_;
+		}
+
+		static constexpr int Size = 0;
+
+		using type = T const &;
+
+	private:
+		DI<T> const &
+			value_;
 	};
 
 	//template <typename T>
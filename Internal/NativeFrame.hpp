@@ -0,0 +1,72 @@
+#pragma once
+
+#include <amx/amx.h>
+
+namespace pawn_natives
+{
+	// One call to a native or hook from Pawn, on the stack for as long as the
+	// call runs.  Each links to the call it interrupted, per thread, so a native
+	// that is re-entered (through a callback in to Pawn that calls it again)
+	// still sees its own AMX and parameters once the inner call returns, and
+	// calls on other threads never see each other's.
+	class NativeFrame
+	{
+	public:
+		NativeFrame(void const * owner, AMX * amx, cell * params)
+		:
+			owner_(owner),
+			amx_(amx),
+			params_(params),
+			prev_(current_)
+		{
+			current_ = this;
+		}
+
+		~NativeFrame()
+		{
+			current_ = prev_;
+		}
+
+		NativeFrame(NativeFrame const &) = delete;
+		NativeFrame & operator=(NativeFrame const &) = delete;
+
+		// The native or hook being called.
+		void const * GetOwner() const { return owner_; }
+		AMX * GetAMX() const { return amx_; }
+		cell * GetParams() const { return params_; }
+
+		// The call this one interrupted, if any.
+		NativeFrame const * GetPrevious() const { return prev_; }
+
+		// The innermost call on this thread.
+		static NativeFrame const * GetCurrent() { return current_; }
+
+		// The innermost call to `owner` on this thread.  This is almost always
+		// the current one, unless that native has called another.
+		static NativeFrame const * Find(void const * owner)
+		{
+			for (NativeFrame const * cur = current_; cur; cur = cur->prev_)
+			{
+				if (cur->owner_ == owner)
+					return cur;
+			}
+			return 0;
+		}
+
+	private:
+		void const * const
+			owner_;
+
+		AMX * const
+			amx_;
+
+		cell * const
+			params_;
+
+		NativeFrame * const
+			prev_;
+
+		static thread_local NativeFrame *
+			current_;
+	};
+}
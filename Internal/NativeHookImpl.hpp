@@ -14,32 +14,18 @@ namespace pawn_natives
 				return original_(PAWN_HOOK_CALLING);
 			}
 
-			~ScopedCall()
-			{
-				if (removed_)
-					hook_.Install();
-			}
-
 		private:
-			ScopedCall(subhook::Hook & hook, implementation_t original)
+			ScopedCall(NativeHookBase & hook, implementation_t original)
 			:
-				hook_(hook),
-				original_(original),
-				removed_(hook.Remove())
+				bypass_(hook),
+				original_(original)
 			{
 			}
 
-			ScopedCall(ScopedCall const &) = default;
-			ScopedCall & operator=(ScopedCall const &) = default;
+			ScopedCall(ScopedCall const &) = delete;
+			ScopedCall & operator=(ScopedCall const &) = delete;
 
-			ScopedCall(ScopedCall && that)
-			:
-				hook_(that.hook_),
-				original_(that.original_),
-				removed_(that.removed_)
-			{
-				that.removed_ = false;
-			}
+			ScopedCall(ScopedCall && that) = default;
 
 			ScopedCall & operator=(ScopedCall const &&) = delete;
 
@@ -47,14 +33,11 @@ namespace pawn_natives
 
 			friend class PAWN_HOOK_NAME<RET, PAWN_HOOK_TYPES>;
 
-			subhook::Hook &
-				hook_;
+			NativeHookBase::ScopedBypass
+				bypass_;
 
 			implementation_t const
 				original_;
-
-			bool
-				removed_;
 		};
 
 		inline RET operator()(PAWN_HOOK_PARAMETERS)
@@ -63,8 +46,8 @@ namespace pawn_natives
 				ret;
 			if (Recursing())
 			{
-				subhook::ScopedHookRemove
-					undo(&GetHook());
+				ScopedBypass
+					undo(*this);
 				ret = original_(PAWN_HOOK_CALLING);
 			}
 			else
@@ -78,7 +61,7 @@ namespace pawn_natives
 		ScopedCall operator*() const
 		{
 			ScopedCall
-				ret(GetHook(), original_);
+				ret(const_cast<PAWN_HOOK_NAME &>(*this), original_);
 			return ret;
 		}
 
@@ -86,8 +69,27 @@ namespace pawn_natives
 		PAWN_HOOK_NAME(char const * const name, implementation_t original, AMX_NATIVE replacement) : NativeHookBase(PAWN_HOOK_NUMBER, name, replacement), original_(original) {}
 		~PAWN_HOOK_NAME() = default;
 
+		// Called from the hook's own `Call`, which knows the exact type.
+		template <class T>
+		cell CallStatic(AMX * amx, cell * params)
+		{
+			T const *
+				that = static_cast<T const *>(this);
+			return CallDoOuter(amx, params, [that](AMX * amx, cell * params)
+			{
+				return CallParams(amx, params, [that](auto & ... args) { return NativeHookBase::CallDo(that, args ...); });
+			});
+		}
+
 	private:
 		cell CallDoInner(AMX * amx, cell * params)
+		{
+			return CallParams(amx, params, [this](auto & ... args) { return this->Do(args ...); });
+		}
+
+		// Read the parameters and pass them to `call`, which runs `Do`.
+		template <typename FUNC>
+		static cell CallParams(AMX * amx, cell * params, FUNC const & call)
 		{
 				int idx = 1;
 			#if PAWN_HOOK_NUMBER >= 1
@@ -154,9 +156,12 @@ namespace pawn_natives
 				ParamCast<P> p(amx, params, idx);
 				idx += ParamCast<P>::Size;
 			#endif
+				// An object lookup (`TryRef`) found nothing.
+				if (!ParamsValid(PAWN_HOOK_CALLING))
+					return 0;
 				RET
-					ret = this->Do(PAWN_HOOK_CALLING);
-				return *(cell *)&ret;
+					ret = call(PAWN_HOOK_CALLING);
+				return ReturnCast<RET>::Get(ret);
 		}
 
 		virtual RET Do(PAWN_HOOK_PARAMETERS) const = 0;
@@ -179,32 +184,18 @@ namespace pawn_natives
 				original_(PAWN_HOOK_CALLING);
 			}
 
-			~ScopedCall()
-			{
-				if (removed_)
-					hook_.Install();
-			}
-
 		private:
-			ScopedCall(subhook::Hook & hook, implementation_t original)
+			ScopedCall(NativeHookBase & hook, implementation_t original)
 			:
-				hook_(hook),
-				original_(original),
-				removed_(hook.Remove())
+				bypass_(hook),
+				original_(original)
 			{
 			}
 
-			ScopedCall(ScopedCall const &) = default;
-			ScopedCall & operator=(ScopedCall const &) = default;
+			ScopedCall(ScopedCall const &) = delete;
+			ScopedCall & operator=(ScopedCall const &) = delete;
 
-			ScopedCall(ScopedCall && that)
-			:
-				hook_(that.hook_),
-				original_(that.original_),
-				removed_(that.removed_)
-			{
-				that.removed_ = false;
-			}
+			ScopedCall(ScopedCall && that) = default;
 
 			ScopedCall & operator=(ScopedCall const &&) = delete;
 
@@ -212,22 +203,19 @@ namespace pawn_natives
 
 			friend class PAWN_HOOK_NAME<void, PAWN_HOOK_TYPES>;
 
-			subhook::Hook &
-				hook_;
+			NativeHookBase::ScopedBypass
+				bypass_;
 
 			implementation_t const
 				original_;
-
-			bool
-				removed_;
 		};
 
 		inline void operator()(PAWN_HOOK_PARAMETERS)
 		{
 			if (Recursing())
 			{
-				subhook::ScopedHookRemove
-					undo(&GetHook());
+				ScopedBypass
+					undo(*this);
 				original_(PAWN_HOOK_CALLING);
 			}
 			else
@@ -240,7 +228,7 @@ namespace pawn_natives
 		ScopedCall operator*() const
 		{
 			ScopedCall
-				ret(GetHook(), original_);
+				ret(const_cast<PAWN_HOOK_NAME &>(*this), original_);
 			return ret;
 		}
 
@@ -248,8 +236,27 @@ namespace pawn_natives
 		PAWN_HOOK_NAME(char const * const name, implementation_t original, AMX_NATIVE replacement) : NativeHookBase(PAWN_HOOK_NUMBER, name, replacement), original_(original) {}
 		~PAWN_HOOK_NAME() = default;
 
+		// Called from the hook's own `Call`, which knows the exact type.
+		template <class T>
+		cell CallStatic(AMX * amx, cell * params)
+		{
+			T const *
+				that = static_cast<T const *>(this);
+			return CallDoOuter(amx, params, [that](AMX * amx, cell * params)
+			{
+				return CallParams(amx, params, [that](auto & ... args) { return NativeHookBase::CallDo(that, args ...); });
+			});
+		}
+
 	private:
 		cell CallDoInner(AMX * amx, cell * params)
+		{
+			return CallParams(amx, params, [this](auto & ... args) { return this->Do(args ...); });
+		}
+
+		// Read the parameters and pass them to `call`, which runs `Do`.
+		template <typename FUNC>
+		static cell CallParams(AMX * amx, cell * params, FUNC const & call)
 		{
 				int idx = 1;
 			#if PAWN_HOOK_NUMBER >= 1
@@ -316,7 +323,10 @@ namespace pawn_natives
 				ParamCast<P> p(amx, params, idx);
 				idx += ParamCast<P>::Size;
 			#endif
-				this->Do(PAWN_HOOK_CALLING);
+				// An object lookup (`TryRef`) found nothing.
+				if (!ParamsValid(PAWN_HOOK_CALLING))
+					return 0;
+				call(PAWN_HOOK_CALLING);
 				return 1;
 		}
 
@@ -0,0 +1,189 @@
+#pragma once
+
+// Per-native call counts and timings.  This is all compiled out unless
+// `PAWN_NATIVES_PROFILE` is defined, and that must be defined the same way in
+// every file that includes these headers, since it changes the native classes.
+
+#ifdef PAWN_NATIVES_PROFILE
+
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+
+#if defined _MSC_VER
+	#include <intrin.h>
+#elif defined __i386__ || defined __x86_64__
+	#include <x86intrin.h>
+#endif
+
+namespace pawn_natives
+{
+	class NativeProfile
+	{
+	public:
+		// Bucket `n` counts the calls that took between `2^(n - 1)` and `2^n`
+		// ticks, the last bucket counts everything longer.
+		static constexpr int Buckets = 32;
+
+		explicit NativeProfile(char const * const name)
+		:
+			name_(name),
+			next_(all_)
+		{
+			Reset();
+			all_ = this;
+		}
+
+		static uint64_t Now()
+		{
+#if defined _MSC_VER || defined __i386__ || defined __x86_64__
+			return __rdtsc();
+#else
+			return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+		}
+
+		void Record(uint64_t ticks)
+		{
+			// Single-threaded, like the AMX, so no locks or atomics.
+			++count_;
+			total_ += ticks;
+			if (ticks < min_)
+				min_ = ticks;
+			if (ticks > max_)
+				max_ = ticks;
+			++histogram_[Bucket(ticks)];
+		}
+
+		void Reset()
+		{
+			count_ = 0;
+			total_ = 0;
+			min_ = UINT64_MAX;
+			max_ = 0;
+			for (uint64_t & bucket : histogram_)
+				bucket = 0;
+		}
+
+		char const * GetName() const { return name_; }
+		uint64_t GetCount() const { return count_; }
+		uint64_t GetTotal() const { return total_; }
+		uint64_t GetMin() const { return count_ ? min_ : 0; }
+		uint64_t GetMax() const { return max_; }
+		uint64_t GetBucket(int bucket) const { return histogram_[bucket]; }
+
+		NativeProfile const * GetNext() const { return next_; }
+		static NativeProfile * GetFirst() { return all_; }
+
+		static NativeProfile * Find(char const * name)
+		{
+			for (NativeProfile * cur = all_; cur; cur = cur->next_)
+			{
+				if (!strcmp(cur->name_, name))
+					return cur;
+			}
+			return 0;
+		}
+
+		static void ResetAll()
+		{
+			for (NativeProfile * cur = all_; cur; cur = cur->next_)
+				cur->Reset();
+		}
+
+		// Convert ticks to microseconds.  The tick rate is measured against the
+		// system clock over the whole time the plugin has been loaded.
+		static double ToMicroseconds(uint64_t ticks)
+		{
+			double
+				seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+			uint64_t
+				elapsed = Now() - startTicks_;
+			if (!elapsed)
+				return 0.0;
+			return (double)ticks * seconds * 1000000.0 / (double)elapsed;
+		}
+
+		// Times everything between its construction and destruction.
+		class Scope
+		{
+		public:
+			explicit Scope(NativeProfile & profile)
+			:
+				profile_(profile),
+				start_(Now())
+			{
+			}
+
+			~Scope()
+			{
+				profile_.Record(Now() - start_);
+			}
+
+		private:
+			Scope() = delete;
+			Scope(Scope const &) = delete;
+			Scope & operator=(Scope const &) = delete;
+
+			NativeProfile &
+				profile_;
+
+			uint64_t const
+				start_;
+		};
+
+	private:
+		static int Bucket(uint64_t ticks)
+		{
+			int
+				bucket = 0;
+#if defined __GNUC__
+			if (ticks)
+				bucket = 64 - __builtin_clzll(ticks);
+#else
+			while (ticks)
+			{
+				++bucket;
+				ticks >>= 1;
+			}
+#endif
+			return bucket < Buckets ? bucket : Buckets - 1;
+		}
+
+		NativeProfile() = delete;
+		NativeProfile(NativeProfile const &) = delete;
+		NativeProfile & operator=(NativeProfile const &) = delete;
+
+		char const * const
+			name_;
+
+		NativeProfile * const
+			next_;
+
+		uint64_t
+			count_;
+
+		uint64_t
+			total_;
+
+		uint64_t
+			min_;
+
+		uint64_t
+			max_;
+
+		uint64_t
+			histogram_[Buckets];
+
+		static NativeProfile *
+			all_;
+
+		static uint64_t const
+			startTicks_;
+
+		static std::chrono::steady_clock::time_point const
+			startTime_;
+	};
+}
+
+#endif
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <amx/amx.h>
+
+#include "NativeFrame.hpp"
+
+namespace pawn_natives
+{
+	int AmxLoad(AMX * amx);
+	int AmxUnload(AMX * amx);
+
+	// A loaded script, from `AmxLoad` to `AmxUnload`.  Anything can keep its
+	// own data for each script here - one object of each type, made the first
+	// time it is asked for and destroyed when the script is unloaded:
+	//
+	//   struct MyCache { ... };
+	//
+	//   MyCache & cache = pawn_natives::NativeScript::Find(amx)->Get<MyCache>();
+	//
+	class NativeScript
+	{
+	public:
+		AMX * GetAMX() const
+		{
+			return amx_;
+		}
+
+		template <typename T>
+		T & Get()
+		{
+			size_t
+				slot = Slot<T>();
+			if (slot >= data_.size())
+				data_.resize(slot + 1);
+			if (!data_[slot])
+				data_[slot] = std::make_shared<T>();
+			return *static_cast<T *>(data_[slot].get());
+		}
+
+		// `NULL` if there isn't one yet.
+		template <typename T>
+		T * Find() const
+		{
+			size_t
+				slot = Slot<T>();
+			return slot < data_.size() ? static_cast<T *>(data_[slot].get()) : 0;
+		}
+
+		// Destroy it early.  `Get` makes a new one.
+		template <typename T>
+		void Reset()
+		{
+			size_t
+				slot = Slot<T>();
+			if (slot < data_.size())
+				data_[slot].reset();
+		}
+
+		// `NULL` if the script isn't loaded.
+		static NativeScript * Find(AMX * amx)
+		{
+			// Natives are usually called from the same script many times in a
+			// row.
+			if (!last_ || last_->amx_ != amx)
+			{
+				auto
+					found = all_.find(amx);
+				if (found == all_.end())
+					return 0;
+				last_ = found->second.get();
+			}
+			return last_;
+		}
+
+		// The script of the innermost call from Pawn on this thread.
+		static NativeScript * GetCurrent()
+		{
+			NativeFrame const *
+				frame = NativeFrame::GetCurrent();
+			return frame ? Find(frame->GetAMX()) : 0;
+		}
+
+		// Every loaded script, in the order they were loaded.
+		static std::vector<NativeScript *> const & GetAll()
+		{
+			return order_;
+		}
+
+	private:
+		friend int AmxLoad(AMX * amx);
+		friend int AmxUnload(AMX * amx);
+
+		explicit NativeScript(AMX * amx)
+		:
+			amx_(amx),
+			data_()
+		{
+		}
+
+		NativeScript(NativeScript const &) = delete;
+		NativeScript & operator=(NativeScript const &) = delete;
+
+		// The same script may be loaded again, which keeps its data.
+		static NativeScript & Add(AMX * amx)
+		{
+			std::unique_ptr<NativeScript> &
+				script = all_[amx];
+			if (!script)
+			{
+				script.reset(new NativeScript(amx));
+				order_.push_back(script.get());
+			}
+			return *script;
+		}
+
+		static void Remove(AMX * amx)
+		{
+			auto
+				found = all_.find(amx);
+			if (found == all_.end())
+				return;
+			for (auto it = order_.begin(); it != order_.end(); ++it)
+			{
+				if (*it == found->second.get())
+				{
+					order_.erase(it);
+					break;
+				}
+			}
+			if (last_ == found->second.get())
+				last_ = 0;
+			// Destroys all its data.
+			all_.erase(found);
+		}
+
+		template <typename T>
+		static size_t Slot()
+		{
+			static size_t const
+				slot = slots_++;
+			return slot;
+		}
+
+		AMX * const
+			amx_;
+
+		std::vector<std::shared_ptr<void>>
+			data_;
+
+		static std::unordered_map<AMX *, std::unique_ptr<NativeScript>>
+			all_;
+
+		static std::vector<NativeScript *>
+			order_;
+
+		static NativeScript *
+			last_;
+
+		static size_t
+			slots_;
+	};
+}
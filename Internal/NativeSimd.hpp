@@ -0,0 +1,307 @@
+#pragma once
+
+// Conversions between unpacked Pawn strings (one character per cell) and C
+// strings, used by all the string parameter types.  There are SSE2 and AVX2
+// versions, picked at run time from what the CPU supports, and a plain version
+// for everything else.  Define `PAWN_NATIVES_NO_SIMD` to only use the plain one.
+//
+// These match the server's `amx_GetString` and `amx_SetString`: narrowing keeps
+// the low byte of each cell, widening sign-extends each `char`.
+
+#include <cstddef>
+#include <cstdint>
+#include <amx/amx.h>
+
+#if !defined PAWN_NATIVES_NO_SIMD && (!defined PAWN_CELL_SIZE || PAWN_CELL_SIZE == 32)
+	#if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+		#define PAWN_NATIVES_SIMD
+		#include <intrin.h>
+		#include <immintrin.h>
+		#define PAWN_NATIVES_TARGET(arch)
+	#elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+		#define PAWN_NATIVES_SIMD
+		#include <immintrin.h>
+		// Only these functions use the instructions, so the rest of the plugin
+		// still runs on CPUs without them.
+		#define PAWN_NATIVES_TARGET(arch) __attribute__((target(arch)))
+	#endif
+#endif
+
+namespace pawn_natives
+{
+	namespace simd
+	{
+		enum class Level
+		{
+			SCALAR,
+			SSE2,
+			AVX2,
+		};
+
+		inline size_t StrLenScalar(cell const * src, size_t max)
+		{
+			size_t
+				i = 0;
+			while (i != max && src[i])
+				++i;
+			return i;
+		}
+
+		inline void NarrowScalar(char * dest, cell const * src, size_t n)
+		{
+			for (size_t i = 0; i != n; ++i)
+				dest[i] = (char)src[i];
+		}
+
+		inline void WidenScalar(cell * dest, char const * src, size_t n)
+		{
+			for (size_t i = 0; i != n; ++i)
+				dest[i] = (cell)src[i];
+		}
+
+#ifdef PAWN_NATIVES_SIMD
+		inline int LowestBit(unsigned int mask)
+		{
+#if defined _MSC_VER
+			unsigned long
+				ret;
+			_BitScanForward(&ret, mask);
+			return (int)ret;
+#else
+			return __builtin_ctz(mask);
+#endif
+		}
+
+		inline Level Detect()
+		{
+#if defined _MSC_VER
+			int
+				info[4];
+			__cpuid(info, 0);
+			int
+				ids = info[0];
+			__cpuid(info, 1);
+			bool
+				sse2 = (info[3] & (1 << 26)) != 0,
+				// The OS must save the AVX registers too.
+				avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6,
+				avx2 = false;
+			if (avx && ids >= 7)
+			{
+				__cpuidex(info, 7, 0);
+				avx2 = (info[1] & (1 << 5)) != 0;
+			}
+#else
+			__builtin_cpu_init();
+			bool
+				sse2 = __builtin_cpu_supports("sse2"),
+				avx2 = __builtin_cpu_supports("avx2");
+#endif
+			if (avx2)
+				return Level::AVX2;
+			if (sse2)
+				return Level::SSE2;
+			return Level::SCALAR;
+		}
+
+		// Vector loads are aligned to their own size, so they never cross in to
+		// the next page even when they read past the end of the string.
+		PAWN_NATIVES_TARGET("sse2") inline size_t StrLenSSE2(cell const * src, size_t max)
+		{
+			size_t
+				i = 0;
+			if ((uintptr_t)src & (sizeof (cell) - 1))
+				return StrLenScalar(src, max);
+			for ( ; ((uintptr_t)(src + i) & 15) && i != max; ++i)
+			{
+				if (!src[i])
+					return i;
+			}
+			__m128i const
+				zero = _mm_setzero_si128();
+			for ( ; i < max; i += 4)
+			{
+				int
+					mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_load_si128((__m128i const *)(src + i)), zero)));
+				if (mask)
+				{
+					i += LowestBit(mask);
+					return i < max ? i : max;
+				}
+			}
+			return max;
+		}
+
+		PAWN_NATIVES_TARGET("avx2") inline size_t StrLenAVX2(cell const * src, size_t max)
+		{
+			size_t
+				i = 0;
+			if ((uintptr_t)src & (sizeof (cell) - 1))
+				return StrLenScalar(src, max);
+			for ( ; ((uintptr_t)(src + i) & 31) && i != max; ++i)
+			{
+				if (!src[i])
+					return i;
+			}
+			__m256i const
+				zero = _mm256_setzero_si256();
+			for ( ; i < max; i += 8)
+			{
+				int
+					mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_load_si256((__m256i const *)(src + i)), zero)));
+				if (mask)
+				{
+					i += LowestBit(mask);
+					return i < max ? i : max;
+				}
+			}
+			return max;
+		}
+
+		PAWN_NATIVES_TARGET("sse2") inline void NarrowSSE2(char * dest, cell const * src, size_t n)
+		{
+			// Masking first means the saturating packs can't change anything.
+			__m128i const
+				mask = _mm_set1_epi32(0xFF);
+			size_t
+				i = 0;
+			for ( ; i + 16 <= n; i += 16)
+			{
+				__m128i
+					a = _mm_and_si128(_mm_loadu_si128((__m128i const *)(src + i)), mask),
+					b = _mm_and_si128(_mm_loadu_si128((__m128i const *)(src + i + 4)), mask),
+					c = _mm_and_si128(_mm_loadu_si128((__m128i const *)(src + i + 8)), mask),
+					d = _mm_and_si128(_mm_loadu_si128((__m128i const *)(src + i + 12)), mask);
+				_mm_storeu_si128((__m128i *)(dest + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+			}
+			NarrowScalar(dest + i, src + i, n - i);
+		}
+
+		PAWN_NATIVES_TARGET("avx2") inline void NarrowAVX2(char * dest, cell const * src, size_t n)
+		{
+			__m256i const
+				mask = _mm256_set1_epi32(0xFF),
+				// The packs work within each 128-bit half, this puts the
+				// groups of four back in order.
+				order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+			size_t
+				i = 0;
+			for ( ; i + 32 <= n; i += 32)
+			{
+				__m256i
+					a = _mm256_and_si256(_mm256_loadu_si256((__m256i const *)(src + i)), mask),
+					b = _mm256_and_si256(_mm256_loadu_si256((__m256i const *)(src + i + 8)), mask),
+					c = _mm256_and_si256(_mm256_loadu_si256((__m256i const *)(src + i + 16)), mask),
+					d = _mm256_and_si256(_mm256_loadu_si256((__m256i const *)(src + i + 24)), mask),
+					packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+				_mm256_storeu_si256((__m256i *)(dest + i), _mm256_permutevar8x32_epi32(packed, order));
+			}
+			NarrowSSE2(dest + i, src + i, n - i);
+		}
+
+		PAWN_NATIVES_TARGET("sse2") inline void WidenSSE2(cell * dest, char const * src, size_t n)
+		{
+			__m128i const
+				zero = _mm_setzero_si128();
+			size_t
+				i = 0;
+			for ( ; i + 16 <= n; i += 16)
+			{
+				__m128i
+					v = _mm_loadu_si128((__m128i const *)(src + i)),
+					sign = _mm_cmpgt_epi8(zero, v),
+					lo = _mm_unpacklo_epi8(v, sign),
+					hi = _mm_unpackhi_epi8(v, sign),
+					loSign = _mm_srai_epi16(lo, 15),
+					hiSign = _mm_srai_epi16(hi, 15);
+				_mm_storeu_si128((__m128i *)(dest + i), _mm_unpacklo_epi16(lo, loSign));
+				_mm_storeu_si128((__m128i *)(dest + i + 4), _mm_unpackhi_epi16(lo, loSign));
+				_mm_storeu_si128((__m128i *)(dest + i + 8), _mm_unpacklo_epi16(hi, hiSign));
+				_mm_storeu_si128((__m128i *)(dest + i + 12), _mm_unpackhi_epi16(hi, hiSign));
+			}
+			WidenScalar(dest + i, src + i, n - i);
+		}
+
+		PAWN_NATIVES_TARGET("avx2") inline void WidenAVX2(cell * dest, char const * src, size_t n)
+		{
+			size_t
+				i = 0;
+			for ( ; i + 16 <= n; i += 16)
+			{
+				__m128i
+					v = _mm_loadu_si128((__m128i const *)(src + i));
+				_mm256_storeu_si256((__m256i *)(dest + i), _mm256_cvtepi8_epi32(v));
+				_mm256_storeu_si256((__m256i *)(dest + i + 8), _mm256_cvtepi8_epi32(_mm_srli_si128(v, 8)));
+			}
+			WidenScalar(dest + i, src + i, n - i);
+		}
+#endif
+
+		// The best version this CPU can run, found once.
+		inline Level GetLevel()
+		{
+#ifdef PAWN_NATIVES_SIMD
+			static Level const
+				level = Detect();
+			return level;
+#else
+			return Level::SCALAR;
+#endif
+		}
+	}
+
+	// The length of an unpacked string, stopping at `max` cells.
+	inline size_t StrLenCells(cell const * src, size_t max = SIZE_MAX)
+	{
+#ifdef PAWN_NATIVES_SIMD
+		switch (simd::GetLevel())
+		{
+		case simd::Level::AVX2:
+			return simd::StrLenAVX2(src, max);
+		case simd::Level::SSE2:
+			return simd::StrLenSSE2(src, max);
+		default:
+			break;
+		}
+#endif
+		return simd::StrLenScalar(src, max);
+	}
+
+	// Convert `n` cells of an unpacked string to `char`s, with no terminator.
+	inline void NarrowCells(char * dest, cell const * src, size_t n)
+	{
+#ifdef PAWN_NATIVES_SIMD
+		switch (simd::GetLevel())
+		{
+		case simd::Level::AVX2:
+			simd::NarrowAVX2(dest, src, n);
+			return;
+		case simd::Level::SSE2:
+			simd::NarrowSSE2(dest, src, n);
+			return;
+		default:
+			break;
+		}
+#endif
+		simd::NarrowScalar(dest, src, n);
+	}
+
+	// Convert `n` `char`s to an unpacked string, with no terminator.
+	inline void WidenChars(cell * dest, char const * src, size_t n)
+	{
+#ifdef PAWN_NATIVES_SIMD
+		switch (simd::GetLevel())
+		{
+		case simd::Level::AVX2:
+			simd::WidenAVX2(dest, src, n);
+			return;
+		case simd::Level::SSE2:
+			simd::WidenSSE2(dest, src, n);
+			return;
+		default:
+			break;
+		}
+#endif
+		simd::WidenScalar(dest, src, n);
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <amx/amx.h>
+
+namespace pawn_natives
+{
+	// The real address of `cells` cells at `addr` in a script, or `NULL` if any
+	// of them are outside its data, heap, or stack.  Checking the whole range
+	// once means each element can then be used without `amx_GetAddr`.
+	inline cell * GetAmxArray(AMX * amx, cell addr, cell cells)
+	{
+		if (cells <= 0 || addr < 0)
+			return 0;
+		// Compare sizes, not ends, so large counts can't overflow.
+		ucell
+			room;
+		if (addr < amx->hea)
+			room = (ucell)(amx->hea - addr);
+		else if (addr >= amx->stk && addr < amx->stp)
+			room = (ucell)(amx->stp - addr);
+		else
+			return 0;
+		if ((ucell)cells > room / sizeof (cell))
+			return 0;
+		cell *
+			ret;
+		return amx_GetAddr(amx, addr, &ret) == AMX_ERR_NONE ? ret : 0;
+	}
+
+	// An array directly in AMX memory, passed from Pawn with its size:
+	//
+	//   native SumValues(const values[], size = sizeof (values));
+	//
+	// `T` is `cell` or `float`, or `const` for arrays the native only reads.
+	// Nothing is copied, so writes go straight back to the script.  Like
+	// `AmxStringView`, don't keep it after the native returns.
+	template <typename T>
+	class AmxSpan
+	{
+		static_assert(sizeof (T) == sizeof (cell), "AmxSpan elements must be one cell each.");
+
+	public:
+		AmxSpan()
+		:
+			data_(0),
+			size_(0)
+		{
+		}
+
+		AmxSpan(T * data, size_t size)
+		:
+			data_(size ? data : 0),
+			size_(data ? size : 0)
+		{
+		}
+
+		// A writable array can always be read.
+		template <typename U, typename = std::enable_if_t<std::is_same<T, U const>::value>>
+		AmxSpan(AmxSpan<U> const & that)
+		:
+			data_(that.data()),
+			size_(that.size())
+		{
+		}
+
+		T * data() const { return data_; }
+		size_t size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+
+		T & operator[](size_t i) const { return data_[i]; }
+
+		T * begin() const { return data_; }
+		T * end() const { return data_ + size_; }
+
+	private:
+		T *
+			data_;
+
+		size_t
+			size_;
+	};
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <amx/amx.h>
+
+#include "NativeSimd.hpp"
+
+namespace pawn_natives
+{
+	// A read-only string directly in AMX memory, for natives that only look at
+	// a string (compare it, hash it, search it) and so don't need a copy.  The
+	// length is found once, when the parameter is read, and characters are only
+	// narrowed from cells when they are used.  Both packed and unpacked strings
+	// work.  Like `std::string_view` it doesn't own the characters, so don't
+	// keep it after the native returns - the script may change them.
+	class AmxStringView
+	{
+	public:
+		class const_iterator
+		{
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef char value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef char const * pointer;
+			typedef char reference;
+
+			const_iterator() : view_(0), pos_(0) {}
+
+			char operator*() const { return (*view_)[pos_]; }
+			char operator[](difference_type n) const { return (*view_)[pos_ + n]; }
+
+			const_iterator & operator++() { ++pos_; return *this; }
+			const_iterator & operator--() { --pos_; return *this; }
+			const_iterator operator++(int) { const_iterator ret = *this; ++pos_; return ret; }
+			const_iterator operator--(int) { const_iterator ret = *this; --pos_; return ret; }
+			const_iterator & operator+=(difference_type n) { pos_ += n; return *this; }
+			const_iterator & operator-=(difference_type n) { pos_ -= n; return *this; }
+			const_iterator operator+(difference_type n) const { const_iterator ret = *this; return ret += n; }
+			const_iterator operator-(difference_type n) const { const_iterator ret = *this; return ret -= n; }
+			difference_type operator-(const_iterator const & that) const { return (difference_type)pos_ - (difference_type)that.pos_; }
+
+			bool operator==(const_iterator const & that) const { return pos_ == that.pos_; }
+			bool operator!=(const_iterator const & that) const { return pos_ != that.pos_; }
+			bool operator<(const_iterator const & that) const { return pos_ < that.pos_; }
+			bool operator>(const_iterator const & that) const { return pos_ > that.pos_; }
+			bool operator<=(const_iterator const & that) const { return pos_ <= that.pos_; }
+			bool operator>=(const_iterator const & that) const { return pos_ >= that.pos_; }
+
+		private:
+			const_iterator(AmxStringView const * view, size_t pos) : view_(view), pos_(pos) {}
+
+			friend class AmxStringView;
+
+			AmxStringView const *
+				view_;
+
+			size_t
+				pos_;
+		};
+
+		AmxStringView()
+		:
+			cells_(0),
+			length_(0),
+			packed_(false)
+		{
+		}
+
+		explicit AmxStringView(cell const * cells)
+		:
+			cells_(cells),
+			length_(0),
+			packed_(cells && (ucell)*cells > UNPACKEDMAX)
+		{
+			if (!cells_)
+				return;
+			if (packed_)
+			{
+				while (CharAt(length_))
+					++length_;
+			}
+			else
+				length_ = StrLenCells(cells_);
+		}
+
+		size_t size() const { return length_; }
+		size_t length() const { return length_; }
+		bool empty() const { return length_ == 0; }
+
+		bool IsPacked() const { return packed_; }
+		cell const * GetCells() const { return cells_; }
+
+		char operator[](size_t i) const
+		{
+			return packed_ ? CharAt(i) : (char)cells_[i];
+		}
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end() const { return const_iterator(this, length_); }
+
+		// Narrow up to `count` characters, starting at `pos`, in to `dest`.
+		// There is no terminator.  Returns the number copied.
+		size_t copy(char * dest, size_t count, size_t pos = 0) const
+		{
+			if (pos >= length_)
+				return 0;
+			if (count > length_ - pos)
+				count = length_ - pos;
+			if (packed_)
+			{
+				for (size_t i = 0; i != count; ++i)
+					dest[i] = CharAt(pos + i);
+			}
+			else
+				NarrowCells(dest, cells_ + pos, count);
+			return count;
+		}
+
+		std::string str() const
+		{
+			std::string
+				ret(length_, '\0');
+			copy(&ret[0], length_);
+			return ret;
+		}
+
+		int compare(std::string_view that) const
+		{
+			size_t
+				len = length_ < that.length() ? length_ : that.length();
+			for (size_t i = 0; i != len; ++i)
+			{
+				unsigned char
+					a = (unsigned char)(*this)[i],
+					b = (unsigned char)that[i];
+				if (a != b)
+					return a < b ? -1 : 1;
+			}
+			if (length_ == that.length())
+				return 0;
+			return length_ < that.length() ? -1 : 1;
+		}
+
+		bool operator==(std::string_view that) const
+		{
+			// The lengths are already known, so most mismatches are free.
+			return length_ == that.length() && compare(that) == 0;
+		}
+
+		bool operator!=(std::string_view that) const
+		{
+			return !(*this == that);
+		}
+
+		bool operator==(AmxStringView const & that) const
+		{
+			if (length_ != that.length_)
+				return false;
+			for (size_t i = 0; i != length_; ++i)
+			{
+				if ((*this)[i] != that[i])
+					return false;
+			}
+			return true;
+		}
+
+		bool operator!=(AmxStringView const & that) const
+		{
+			return !(*this == that);
+		}
+
+		// FNV-1a, the same for packed and unpacked copies of a string.
+		size_t Hash() const
+		{
+			size_t
+				ret = sizeof (size_t) == 8 ? (size_t)14695981039346656037ULL : (size_t)2166136261U;
+			for (size_t i = 0; i != length_; ++i)
+			{
+				ret ^= (unsigned char)(*this)[i];
+				ret *= sizeof (size_t) == 8 ? (size_t)1099511628211ULL : (size_t)16777619U;
+			}
+			return ret;
+		}
+
+	private:
+		// Packed strings store the first character in the top byte of a cell.
+		char CharAt(size_t i) const
+		{
+			return (char)(cells_[i / sizeof (cell)] >> ((sizeof (cell) - 1 - i % sizeof (cell)) * 8));
+		}
+
+		cell const *
+			cells_;
+
+		size_t
+			length_;
+
+		bool
+			packed_;
+	};
+
+	// A string output buffer directly in AMX memory, for natives that only write
+	// a string (`GetPlayerName` etc).  Unlike `std::string *` the old contents
+	// are never read, and the text is converted straight in to the script's
+	// buffer, truncated to fit, so there is no copy and no allocation.  Nothing
+	// is written, not even the terminator, unless the native writes something.
+	class AmxStringOutput
+	{
+	public:
+		AmxStringOutput()
+		:
+			cells_(0),
+			capacity_(0),
+			length_(0)
+		{
+		}
+
+		// `size` is the size of the buffer in cells, including the terminator.
+		AmxStringOutput(cell * cells, size_t size)
+		:
+			cells_(size ? cells : 0),
+			capacity_(size ? size - 1 : 0),
+			length_(0)
+		{
+		}
+
+		// The most characters that fit.
+		size_t capacity() const { return capacity_; }
+
+		// The characters written so far.
+		size_t size() const { return length_; }
+		size_t length() const { return length_; }
+
+		cell * GetCells() const { return cells_; }
+
+		// Replace the contents.  Returns the number of characters written.
+		size_t assign(std::string_view str)
+		{
+			length_ = 0;
+			return append(str);
+		}
+
+		size_t append(std::string_view str)
+		{
+			if (!cells_)
+				return 0;
+			size_t
+				len = str.length() < capacity_ - length_ ? str.length() : capacity_ - length_;
+			WidenChars(cells_ + length_, str.data(), len);
+			length_ += len;
+			cells_[length_] = 0;
+			return len;
+		}
+
+		AmxStringOutput & operator=(std::string_view str)
+		{
+			assign(str);
+			return *this;
+		}
+
+		AmxStringOutput & operator+=(std::string_view str)
+		{
+			append(str);
+			return *this;
+		}
+
+	private:
+		cell *
+			cells_;
+
+		size_t
+			capacity_;
+
+		size_t
+			length_;
+	};
+
+	inline bool operator==(std::string_view a, AmxStringView const & b)
+	{
+		return b == a;
+	}
+
+	inline bool operator!=(std::string_view a, AmxStringView const & b)
+	{
+		return b != a;
+	}
+}
+
+namespace std
+{
+	template <>
+	struct hash<pawn_natives::AmxStringView>
+	{
+		size_t operator()(pawn_natives::AmxStringView const & view) const
+		{
+			return view.Hash();
+		}
+	};
+}
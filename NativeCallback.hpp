@@ -0,0 +1,291 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "NativeImport.hpp"
+#include "Internal/NativeCast.hpp"
+#include "Internal/NativeScript.hpp"
+
+#define PAWN_NATIVES_HAS_CALLBACK
+
+namespace pawn_natives
+{
+	int AmxLoad(AMX * amx);
+	int AmxUnload(AMX * amx);
+
+	// How each type of argument is given to a public function.  `T` has no
+	// `const` or `&`.
+	template <typename T, typename = void>
+	struct CallbackArg
+	{
+		static int Push(AMX * amx, T value)
+		{
+			return amx_Push(amx, (cell)value);
+		}
+	};
+
+	template <>
+	struct CallbackArg<float>
+	{
+		static int Push(AMX * amx, float value)
+		{
+			return amx_Push(amx, amx_ftoc(value));
+		}
+	};
+
+	template <>
+	struct CallbackArg<char const *>
+	{
+		static int Push(AMX * amx, char const * value)
+		{
+			return amx_PushString(amx, 0, 0, value ? value : "", 0, 0);
+		}
+	};
+
+	template <>
+	struct CallbackArg<std::string>
+	{
+		static int Push(AMX * amx, std::string const & value)
+		{
+			return amx_PushString(amx, 0, 0, value.c_str(), 0, 0);
+		}
+	};
+
+	template <>
+	struct CallbackArg<std::string_view>
+	{
+		static int Push(AMX * amx, std::string_view value)
+		{
+			// `amx_PushString` wants a terminated string.
+			cell *
+				dest;
+			int
+				err = amx_PushArray(amx, 0, &dest, 0, (int)value.length() + 1);
+			if (err == AMX_ERR_NONE)
+			{
+				for (char c : value)
+					*dest++ = (cell)c;
+				*dest = 0;
+			}
+			return err;
+		}
+	};
+
+	// Copied to the script, so it can't change the original.
+	template <>
+	struct CallbackArg<std::vector<cell>>
+	{
+		static int Push(AMX * amx, std::vector<cell> const & value)
+		{
+			return amx_PushArray(amx, 0, 0, value.data(), (int)value.size());
+		}
+	};
+
+	// The index of every public we call in one script, by callback.
+	struct NativeCallbackIndices
+	{
+		std::vector<int>
+			indices;
+	};
+
+	// A public function in every script, found by name once when each script
+	// is loaded instead of with `amx_FindPublic` on every call.
+	class NativeCallbackBase
+	{
+	public:
+		char const * GetName() const
+		{
+			return name_;
+		}
+
+		// The public's index in `amx`, or `-1` if the script doesn't have it.
+		int GetIndex(AMX * amx) const
+		{
+			NativeScript *
+				script = NativeScript::Find(amx);
+			return script ? GetIndex(*script) : -1;
+		}
+
+		int GetIndex(NativeScript const & script) const
+		{
+			NativeCallbackIndices *
+				found = script.Find<NativeCallbackIndices>();
+			return found && id_ < found->indices.size() ? found->indices[id_] : -1;
+		}
+
+	protected:
+		NativeCallbackBase(char const * const name)
+		:
+			name_(name),
+			id_(count_++),
+			next_(all_)
+		{
+			all_ = this;
+		}
+
+		~NativeCallbackBase() = default;
+
+		// Pushes the arguments, runs the public, and cleans up after it.
+		// Arguments go on the stack last first, so are also converted last
+		// first.
+		template <typename ... TS>
+		cell Exec(AMX * amx, int index, TS const & ... args) const
+		{
+			cell
+				hea = amx->hea,
+				ret = 0;
+			int
+				err = AMX_ERR_NONE;
+			PushArgs(amx, err, args ...);
+			if (err == AMX_ERR_NONE)
+			{
+				err = amx_Exec(amx, &ret, index);
+			}
+			else
+			{
+				// Take back whatever did fit.
+				amx->stk += amx->paramcount * sizeof (cell);
+				amx->paramcount = 0;
+			}
+			amx_Release(amx, hea);
+			if (err != AMX_ERR_NONE)
+			{
+				char
+					msg[1024];
+				sprintf(msg, "Error %d calling public %s", err, name_);
+				LOG_NATIVE_ERROR(msg);
+				return 0;
+			}
+			return ret;
+		}
+
+	private:
+		friend int AmxLoad(AMX * amx);
+		friend int AmxUnload(AMX * amx);
+
+		NativeCallbackBase() = delete;
+		NativeCallbackBase(NativeCallbackBase const &) = delete;
+		NativeCallbackBase const & operator=(NativeCallbackBase const &) = delete;
+
+		static void PushArgs(AMX *, int &)
+		{
+		}
+
+		template <typename T, typename ... TS>
+		static void PushArgs(AMX * amx, int & err, T const & arg, TS const & ... args)
+		{
+			PushArgs(amx, err, args ...);
+			if (err == AMX_ERR_NONE)
+				err = CallbackArg<T>::Push(amx, arg);
+		}
+
+		void Load(NativeScript & script)
+		{
+			int
+				index;
+			if (amx_FindPublic(script.GetAMX(), name_, &index) != AMX_ERR_NONE)
+				index = -1;
+			std::vector<int> &
+				indices = script.Get<NativeCallbackIndices>().indices;
+			if (indices.size() <= id_)
+				indices.resize(count_, -1);
+			indices[id_] = index;
+		}
+
+		char const * const
+			name_;
+
+		// Where this callback's index is in each script's list.
+		size_t const
+			id_;
+
+		NativeCallbackBase * const
+			next_;
+
+		static NativeCallbackBase *
+			all_;
+
+		static size_t
+			count_;
+	};
+
+	template <typename T>
+	class NativeCallback
+	{
+	};
+
+	template <typename RET, typename ... TS>
+	class NativeCallback<RET(TS ...)> : public NativeCallbackBase
+	{
+	public:
+		NativeCallback(char const * const name)
+		:
+			NativeCallbackBase(name)
+		{
+		}
+
+		// Call the public in one script.  Returns `0` if it doesn't have it.
+		RET Call(AMX * amx, TS ... args) const
+		{
+			int
+				index = GetIndex(amx);
+			cell
+				ret = 0;
+			if (index >= 0)
+				ret = Exec(amx, index, args ...);
+			return Result(ret);
+		}
+
+		// Call the public in every script that has it, in the order they were
+		// loaded.  Returns what the last one returned.
+		RET operator()(TS ... args) const
+		{
+			cell
+				ret = 0;
+			// A public may load or unload scripts, so go through a copy of the
+			// list, and skip any script unloaded before its turn.
+			std::vector<AMX *>
+				amxs;
+			amxs.reserve(NativeScript::GetAll().size());
+			for (NativeScript * script : NativeScript::GetAll())
+				amxs.push_back(script->GetAMX());
+			for (AMX * amx : amxs)
+			{
+				NativeScript *
+					script = NativeScript::Find(amx);
+				if (!script)
+					continue;
+				int
+					index = GetIndex(*script);
+				if (index >= 0)
+					ret = Exec(amx, index, args ...);
+			}
+			return Result(ret);
+		}
+
+	private:
+		static RET Result(cell ret)
+		{
+			if constexpr (!std::is_void<RET>::value)
+				return ParamLookup<RET>::Val(ret);
+		}
+	};
+}
+
+// Declares a public function that scripts may have, to call from C++:
+//
+//   PAWN_CALLBACK(Callbacks, OnPlayerScore, bool(int playerid, float score, char const * name));
+//
+//   Callbacks::OnPlayerScore.Call(amx, playerid, 4.5f, "Bob");
+//   Callbacks::OnPlayerScore(playerid, 4.5f, "Bob");
+//
+#define PAWN_CALLBACK(nspace, func, type) PAWN_CALLBACK_(nspace, func, type)
+#define PAWN_CALLBACK_(nspace, func, type) \
+	namespace nspace                                                            \
+	{                                                                           \
+	    inline pawn_natives::NativeCallback<type>                               \
+	        func(#func);                                                        \
+	}
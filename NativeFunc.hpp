@@ -1,16 +1,18 @@
 #pragma once
 
 #include <stdexcept>
-#include <list>
 
 #include "NativeImport.hpp"
 #include "Internal/NativeCast.hpp"
+#include "Internal/NativeFrame.hpp"
+#include "Internal/NativeProfile.hpp"
 
 #define PAWN_NATIVES_HAS_FUNC
 
 namespace pawn_natives
 {
 	int AmxLoad(AMX * amx);
+	int AmxUnload(AMX * amx);
 
 	class NativeFuncBase
 	{
@@ -26,35 +28,64 @@ namespace pawn_natives
 		:
 			count_(count * sizeof (cell)),
 			name_(name),
-			native_(native),
-			amx_(0),
-			params_(0)
+			native_(native)
+#ifdef PAWN_NATIVES_PROFILE
+			,
+			profile_(name)
+#endif
+			,
+			next_(all_)
 		{
-			if (!all_)
-				all_ = new std::list<NativeFuncBase *>();
-			if (all_)
-				all_->push_back(this);
+			// Constructed during static initialisation, but `all_` is
+			// zero-initialised before any of that, so no allocation and no
+			// dependence on the order files are initialised in.
+			all_ = this;
 		}
 		
 		~NativeFuncBase() = default;
 
-		AMX * GetAMX() const { return amx_; }
-		cell * GetParams() const { return params_; }
+		// The script and parameters of the innermost call from Pawn on this
+		// thread, or `NULL` outside of one.
+		AMX * GetAMX() const
+		{
+			NativeFrame const *
+				frame = NativeFrame::Find(this);
+			return frame ? frame->GetAMX() : 0;
+		}
+
+		cell * GetParams() const
+		{
+			NativeFrame const *
+				frame = NativeFrame::Find(this);
+			return frame ? frame->GetParams() : 0;
+		}
 		
 		cell CallDoOuter(AMX * amx, cell * params)
+		{
+			return CallDoOuter(amx, params, [this](AMX * amx, cell * params) { return this->CallDoInner(amx, params); });
+		}
+
+		// The same, but with the inner call given directly instead of through
+		// the virtual `CallDoInner`, so all of it can be inlined.
+		template <typename F>
+		cell CallDoOuter(AMX * amx, cell * params, F const & inner)
 		{
 			cell
 				ret = 0;
 			if (amx && params)
 			{
+#ifdef PAWN_NATIVES_PROFILE
+				NativeProfile::Scope
+					timer(profile_);
+#endif
+				NativeFrame
+					frame(this, amx, params);
 				// Check that there are enough parameters.
-				amx_ = amx;
-				params_ = params;
 				try
 				{
 					if (count_ > (unsigned int)params[0])
 						throw std::invalid_argument("Insufficient arguments.");
-					ret = this->CallDoInner(amx, params);
+					ret = inner(amx, params);
 				}
 				catch (ParamCastFailure const &)
 				{
@@ -73,16 +104,36 @@ namespace pawn_natives
 						msg[1024];
 					sprintf(msg, "Unknown exception in in %s", name_);
 					LOG_NATIVE_ERROR(msg);
-					params_ = 0;
-					amx_ = 0;
 					throw;
 				}
-				params_ = 0;
-				amx_ = 0;
 			}
 			return (cell)ret;
 		}
 
+		// For `PAWN_NATIVE_NOEXCEPT` - no `try`, so nothing `inner` calls may
+		// throw.  Lookups that fail return `0` from `inner` instead.
+		template <typename F>
+		cell CallDoOuterNoexcept(AMX * amx, cell * params, F const & inner) noexcept
+		{
+			if (!amx || !params)
+				return 0;
+			if (count_ > (unsigned int)params[0])
+			{
+				char
+					msg[1024];
+				sprintf(msg, "Insufficient arguments in %s", name_);
+				LOG_NATIVE_ERROR(msg);
+				return 0;
+			}
+#ifdef PAWN_NATIVES_PROFILE
+			NativeProfile::Scope
+				timer(profile_);
+#endif
+			NativeFrame
+				frame(this, amx, params);
+			return inner(amx, params);
+		}
+
 	private:
 		virtual cell CallDoInner(AMX *, cell *) = 0;
 
@@ -103,16 +154,21 @@ namespace pawn_natives
 		AMX_NATIVE const
 			native_;
 
-		AMX *
-			amx_;
+#ifdef PAWN_NATIVES_PROFILE
+		NativeProfile
+			profile_;
+#endif
 
-		cell *
-			params_;
+		NativeFuncBase * const
+			next_;
 
-		static std::list<NativeFuncBase *> *
+		static NativeFuncBase *
 			all_;
 	};
 
+	template <class T>
+	class NativeBatch;
+
 	template <typename RET, typename ... TS>
 	class NativeFunc : protected NativeFuncBase
 	{
@@ -123,13 +179,43 @@ namespace pawn_natives
 		NativeFunc(char const * const name, AMX_NATIVE native) : NativeFuncBase(ParamData<TS ...>::Sum(), name, native) {}
 		~NativeFunc() = default;
 
+		// Called from the native's own `Call`, which knows the exact (`final`)
+		// type, so calling `operator()` isn't virtual either.
+		template <class T>
+		cell CallStatic(AMX * amx, cell * params)
+		{
+			return CallDoOuter(amx, params, [this](AMX * amx, cell * params)
+			{
+				cell
+					ret = 0;
+				ParamData<TS ...>::TryCall(static_cast<T const *>(this), amx, params, ret);
+				return ret;
+			});
+		}
+
+		template <class T>
+		cell CallNoexcept(AMX * amx, cell * params) noexcept
+		{
+			return CallDoOuterNoexcept(amx, params, [this](AMX * amx, cell * params)
+			{
+				cell
+					ret = 0;
+				ParamData<TS ...>::TryCall(static_cast<T const *>(this), amx, params, ret);
+				return ret;
+			});
+		}
+
 	private:
+		// Calls `CallStatic` for each element.
+		template <class T>
+		friend class NativeBatch;
 
 		cell CallDoInner(AMX * amx, cell * params)
 		{
-			RET
-				ret = ParamData<TS ...>::Call(this, amx, params);
-			return *(cell *)&ret;
+			cell
+				ret = 0;
+			ParamData<TS ...>::TryCall(this, amx, params, ret);
+			return ret;
 		}
 	};
 
@@ -143,11 +229,41 @@ namespace pawn_natives
 		NativeFunc(char const * const name, AMX_NATIVE native) : NativeFuncBase(ParamData<TS ...>::Sum(), name, native) {}
 		~NativeFunc() = default;
 
+		template <class T>
+		cell CallStatic(AMX * amx, cell * params)
+		{
+			return CallDoOuter(amx, params, [this](AMX * amx, cell * params)
+			{
+				cell
+					ret = 0;
+				ParamData<TS ...>::TryCall(static_cast<T const *>(this), amx, params, ret);
+				return ret;
+			});
+		}
+
+		template <class T>
+		cell CallNoexcept(AMX * amx, cell * params) noexcept
+		{
+			return CallDoOuterNoexcept(amx, params, [this](AMX * amx, cell * params)
+			{
+				cell
+					ret = 0;
+				ParamData<TS ...>::TryCall(static_cast<T const *>(this), amx, params, ret);
+				return ret;
+			});
+		}
+
 	private:
+		// Calls `CallStatic` for each element.
+		template <class T>
+		friend class NativeBatch;
+
 		cell CallDoInner(AMX * amx, cell * params)
 		{
-			ParamData<TS ...>::Call(this, amx, params);
-			return 0;
+			cell
+				ret = 0;
+			ParamData<TS ...>::TryCall(this, amx, params, ret);
+			return ret;
 		}
 	};
 
@@ -161,12 +277,35 @@ namespace pawn_natives
 		NativeFunc(char const * const name, AMX_NATIVE native) : NativeFuncBase(0, name, native) {}
 		~NativeFunc() = default;
 
+		template <class T>
+		cell CallStatic(AMX * amx, cell * params)
+		{
+			return CallDoOuter(amx, params, [this](AMX * amx, cell * params)
+			{
+				RET
+					ret = ParamData<>::Call(static_cast<T const *>(this), amx, params);
+				return ReturnCast<RET>::Get(ret);
+			});
+		}
+
+		template <class T>
+		cell CallNoexcept(AMX * amx, cell * params) noexcept
+		{
+			return CallDoOuterNoexcept(amx, params, [this](AMX * amx, cell * params)
+			{
+				cell
+					ret = 0;
+				ParamData<>::TryCall(static_cast<T const *>(this), amx, params, ret);
+				return ret;
+			});
+		}
+
 	private:
 		cell CallDoInner(AMX * amx, cell * params)
 		{
 			RET
 				ret = ParamData<>::Call(this, amx, params);
-			return *(cell *)&ret;
+			return ReturnCast<RET>::Get(ret);
 		}
 	};
 
@@ -180,6 +319,28 @@ namespace pawn_natives
 		NativeFunc(char const * const name, AMX_NATIVE native) : NativeFuncBase(0, name, native) {}
 		~NativeFunc() = default;
 
+		template <class T>
+		cell CallStatic(AMX * amx, cell * params)
+		{
+			return CallDoOuter(amx, params, [this](AMX * amx, cell * params)
+			{
+				ParamData<>::Call(static_cast<T const *>(this), amx, params);
+				return (cell)0;
+			});
+		}
+
+		template <class T>
+		cell CallNoexcept(AMX * amx, cell * params) noexcept
+		{
+			return CallDoOuterNoexcept(amx, params, [this](AMX * amx, cell * params)
+			{
+				cell
+					ret = 0;
+				ParamData<>::TryCall(static_cast<T const *>(this), amx, params, ret);
+				return ret;
+			});
+		}
+
 	private:
 		cell CallDoInner(AMX * amx, cell * params)
 		{
@@ -187,6 +348,109 @@ namespace pawn_natives
 			return 0;
 		}
 	};
+
+	// Which parameters can be batched: ones Pawn passes by value - numbers,
+	// enums, and objects by ID - plus injected ones, which Pawn doesn't pass at
+	// all.  Not pointers or anything else that is an address in the script,
+	// because each element would be used as one without being checked.
+	template <typename T>
+	struct BatchParam : std::bool_constant<std::is_arithmetic<T>::value || std::is_enum<T>::value || ParamCast<T>::Size == 0>
+	{
+	};
+
+	template <typename T>
+	struct BatchParam<T *> : std::false_type
+	{
+	};
+
+	// Only references to objects looked up by ID, not others such as
+	// `std::string const &`, whose cell is an address.
+	template <typename T>
+	struct BatchParam<T &> : std::bool_constant<HasRef<std::remove_const_t<T>>::value || HasTryRef<std::remove_const_t<T>>::value || HasBorrow<std::remove_const_t<T>>::value>
+	{
+	};
+
+	template <typename T>
+	struct BatchParam<DI<T> const &> : std::true_type
+	{
+	};
+
+	template <typename T>
+	struct BatchParam<std::shared_ptr<T>> : std::true_type
+	{
+	};
+
+	// The array version of a native, from `PAWN_NATIVE_BATCH`.  It takes an
+	// array for each of the native's parameters then a count, and calls the
+	// native once for each element - one call from Pawn instead of hundreds.
+	// Returns how many calls returned non-zero (or were made, for `void`).
+	template <template <typename> class N, typename RET, typename ... TS>
+	class NativeBatch<N<RET(TS ...)>> final : protected NativeFuncBase
+	{
+		static_assert((BatchParam<TS>::value && ...), "Batched natives can only take numbers, enums, objects, and injected parameters (see BatchParam).");
+
+	public:
+		NativeBatch(char const * const name, N<RET(TS ...)> & native)
+		:
+			NativeFuncBase(Count + 1, name, (AMX_NATIVE)&Call),
+			native_(native)
+		{
+			instance_ = this;
+		}
+
+	private:
+		// Cells, not parameters - injected ones don't come from Pawn.
+		static constexpr size_t
+			Count = (0 + ... + ParamCast<TS>::Size);
+
+		static_assert(Count != 0, "Batched natives need parameters.");
+
+		static cell AMX_NATIVE_CALL Call(AMX * amx, cell * params)
+		{
+			NativeBatch *
+				that = instance_;
+			return that->CallDoOuter(amx, params, [that](AMX * amx, cell * params) { return that->CallEach(amx, params); });
+		}
+
+		cell CallDoInner(AMX * amx, cell * params) override
+		{
+			return CallEach(amx, params);
+		}
+
+		cell CallEach(AMX * amx, cell * params)
+		{
+			cell
+				count = params[Count + 1],
+				ret = 0;
+			if (count <= 0)
+				return 0;
+			// Check every array is all there once, not every element.
+			cell *
+				arrays[Count];
+			for (size_t i = 0; i != Count; ++i)
+			{
+				if (!(arrays[i] = GetAmxArray(amx, params[i + 1], count)))
+					return 0;
+			}
+			// The parameters for one call, made from one element of each.
+			cell
+				one[Count + 1] = { Count * sizeof (cell) };
+			for (cell k = 0; k != count; ++k)
+			{
+				for (size_t i = 0; i != Count; ++i)
+					one[i + 1] = arrays[i][k];
+				if (native_.template CallStatic<N<RET(TS ...)>>(amx, one) || std::is_void<RET>::value)
+					++ret;
+			}
+			return ret;
+		}
+
+		N<RET(TS ...)> &
+			native_;
+
+		static inline NativeBatch *
+			instance_ = 0;
+	};
 }
 
 // The hooks and calls for each class are always static, because otherwise it
@@ -200,12 +464,14 @@ namespace pawn_natives
 // use the common `IsEnabled` method, so re-export it.
 #define PAWN_NATIVE_DECL(object, func, type) PAWN_NATIVE_DECL_(object, func, type)
 
-#define PAWN_NATIVE_DECL_(object, func, params) \
+#define PAWN_NATIVE_DECL_(object, func, params) PAWN_NATIVE_DECL__(object, func, params, )
+
+#define PAWN_NATIVE_DECL__(object, func, params, spec) \
 	template <typename F>                                                       \
 	class Native_##func##_ {};                                                  \
 	                                                                            \
 	template <typename RET, typename ... TS>                                    \
-	class Native_##func##_<RET(TS ...)> :                                       \
+	class Native_##func##_<RET(TS ...)> final :                                 \
 	    public pawn_natives::NativeFunc<RET, TS ...>                            \
 	{                                                                           \
 	public:                                                                     \
@@ -215,7 +481,7 @@ namespace pawn_natives
 	    {                                                                       \
 	    }                                                                       \
 	                                                                            \
-	    RET operator()(TS ...) const override;                                  \
+	    RET operator()(TS ...) const spec override;                             \
 	                                                                            \
 	private:                                                                    \
 	    static cell AMX_NATIVE_CALL Call(AMX * amx, cell * args);               \
@@ -236,7 +502,7 @@ namespace pawn_natives
 	template <>                                                                 \
 	cell AMX_NATIVE_CALL Native_##func::Call(AMX * amx, cell * args)            \
 	{                                                                           \
-	    return func.CallDoOuter(amx, args);                                     \
+	    return func.CallStatic<Native_##func>(amx, args);                       \
 	}                                                                           \
 	                                                                            \
 	template <>                                                                 \
@@ -279,6 +545,56 @@ namespace pawn_natives
 
 #define PAWN_NATIVE(object, func, params) PAWN_NATIVE_DECL_(object, func, params); PAWN_NATIVE_DEFN_(object, func, params)
 
+// The same as `PAWN_NATIVE`, plus `func##Batch` for Pawn, which takes an array
+// for each parameter and a count (see `NativeBatch`).
+#define PAWN_NATIVE_BATCH(object, func, params) PAWN_NATIVE_DECL_(object, func, params); PAWN_NATIVE_BATCH_(func); PAWN_NATIVE_DEFN_(object, func, params)
+
+#define PAWN_NATIVE_BATCH_(func) pawn_natives::NativeBatch<Native_##func> func##Batch(#func "Batch", func)
+
+// A native for hot paths, with no exception handling at all.  Object lookups
+// that fail (see `HasTryRef`) skip the call and return `0`, as normal natives
+// do, but without throwing anything.  Everything else - the parameters and
+// the body - must not throw, because nothing will catch it.  The parameters
+// are checked with `ParamNoexcept`; the body is up to you.
+#define PAWN_NATIVE_NOEXCEPT_DECL(object, func, type) PAWN_NATIVE_DECL__(object, func, type, noexcept)
+
+#define PAWN_NATIVE_NOEXCEPT_DEFN(object, func, params) PAWN_NATIVE_NOEXCEPT_DEFN_(object, func, params)
+
+#define PAWN_NATIVE_NOEXCEPT_DEFN_(object, func, params) \
+	static_assert(pawn_natives::ParamsNoexcept<params>::value,                  \
+	    "PAWN_NATIVE_NOEXCEPT parameters must not throw (see ParamNoexcept)."); \
+	                                                                            \
+	Native_##func func;                                                         \
+	                                                                            \
+	template <>                                                                 \
+	cell AMX_NATIVE_CALL Native_##func::Call(AMX * amx, cell * args)            \
+	{                                                                           \
+	    return func.CallNoexcept<Native_##func>(amx, args);                     \
+	}                                                                           \
+	                                                                            \
+	template <>                                                                 \
+	PAWN_NATIVE__RETURN(params)                                                 \
+	    Native_##func::                                                         \
+	    operator()(PAWN_NATIVE__PARAMETERS(params)) const noexcept;             \
+	                                                                            \
+	template <typename RET, typename ... TS>                                    \
+	typename pawn_natives::ReturnResolver<RET>::type NATIVE_##func(TS ... args) noexcept \
+	{                                                                           \
+	    PAWN_NATIVE__GET_RETURN(params)(func(args ...));                        \
+	}                                                                           \
+	                                                                            \
+	PAWN_NATIVE_EXTERN template PAWN_NATIVE_DLLEXPORT                           \
+	typename pawn_natives::ReturnResolver<PAWN_NATIVE__RETURN(params)>::type    \
+	PAWN_NATIVE_API                                                             \
+	    NATIVE_##func<PAWN_NATIVE__RETURN(params)>(PAWN_NATIVE__PARAMETERS(params)); \
+	                                                                            \
+	template <>                                                                 \
+	PAWN_NATIVE__RETURN(params)                                                 \
+	    Native_##func::                                                         \
+	    operator()(PAWN_NATIVE__PARAMETERS(params)) const noexcept
+
+#define PAWN_NATIVE_NOEXCEPT(object, func, params) PAWN_NATIVE_DECL__(object, func, params, noexcept); PAWN_NATIVE_NOEXCEPT_DEFN_(object, func, params)
+
 
 #define PAWN_METHOD_DECL(object, func, type) PAWN_METHOD_DECL_(object, func, type)
 
@@ -287,19 +603,19 @@ namespace pawn_natives
 	class Native_##object##_##func##_ {};                                       \
 	                                                                            \
 	template <typename RET, class C, typename ... TS>                           \
-	class Native_##object##_##func##_<RET(C::*)(TS ...)> :                      \
-	    public pawn_natives::NativeFunc<RET, std::shared_ptr<C>, TS ...>        \
+	class Native_##object##_##func##_<RET(C::*)(TS ...)> final :                \
+	    public pawn_natives::NativeFunc<RET, C &, TS ...>                       \
 	{                                                                           \
 	public:                                                                     \
 	    Native_##object##_##func##_()                                           \
 	    :                                                                       \
-	        pawn_natives::NativeFunc<RET, std::shared_ptr<C>, TS ...>(#object "_" #func, (AMX_NATIVE)&Call) \
+	        pawn_natives::NativeFunc<RET, C &, TS ...>(#object "_" #func, (AMX_NATIVE)&Call) \
 	    {                                                                       \
 	    }                                                                       \
 	                                                                            \
-	    RET operator()(std::shared_ptr<C> c, TS... args) const override         \
+	    RET operator()(C & c, TS... args) const override                        \
         {																		\
-			PAWN_NATIVE__GET_RETURN(params)((*c.*P)(std::forward<TS>(args)...));\
+			PAWN_NATIVE__GET_RETURN(params)((c.*P)(std::forward<TS>(args)...));\
         }																		\
 	                                                                            \
 	private:                                                                    \
@@ -325,7 +641,7 @@ namespace pawn_natives
 	template <>                                                                 \
 	cell AMX_NATIVE_CALL Native_##object##_##func::Call(AMX * amx, cell * args) \
 	{                                                                           \
-	    return func.CallDoOuter(amx, args);                                     \
+	    return func.CallStatic<Native_##object##_##func>(amx, args);            \
 	}                                                                           \
 	                                                                            \
 	template <typename RET, class C, typename ... TS>                           \
@@ -333,7 +649,7 @@ namespace pawn_natives
 	{                                                                           \
 	    try                                                                     \
 	    {                                                                       \
-	        PAWN_NATIVE__GET_RETURN(params)(func(c, std::forward<TS>(args)...));\
+	        PAWN_NATIVE__GET_RETURN(params)(func(*c, std::forward<TS>(args)...));\
 	    }                                                                       \
 	    catch (std::exception & e)                                              \
 	    {                                                                       \
@@ -351,7 +667,7 @@ namespace pawn_natives
 	PAWN_NATIVE_EXTERN template PAWN_NATIVE_DLLEXPORT                           \
 	typename pawn_natives::ReturnResolver<PAWN_NATIVE__RETURN(params)>::type    \
 	PAWN_NATIVE_API                                                             \
-	    NATIVE_##object##_##func<PAWN_NATIVE__RETURN(params)>(DEFER(PAWN_NATIVE_ADD_POINTER)(object, PAWN_NATIVE__PARAMETERS(params))); \
+	    NATIVE_##object##_##func<PAWN_NATIVE__RETURN(params)>(PAWN_NATIVE_ADD_POINTER(object, PAWN_NATIVE__PARAMETERS(params))); \
 	                                                                            \
 	PAWN_NATIVE__RETURN(params)                                                 \
 	    object::func(PAWN_NATIVE__PARAMETERS(params))
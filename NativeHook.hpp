@@ -1,18 +1,56 @@
 #pragma once
 
 #include <stdexcept>
-#include <list>
+#include <utility>
+#include <vector>
 
 #include <subhook/subhook.h>
 
 #include "NativeImport.hpp"
 #include "Internal/NativeCast.hpp"
+#include "Internal/NativeFrame.hpp"
+#include "Internal/NativeProfile.hpp"
+#include "Internal/NativeScript.hpp"
 
 #define PAWN_NATIVES_HAS_HOOK
 
+// How a hook is installed and how it calls the original native.  `SUBHOOK`
+// removes the hook, calls the original, and reinstalls the hook - two code
+// rewrites per call.  `TRAMPOLINE` installs the hook once and calls the
+// original through subhook's trampoline, falling back to `SUBHOOK` for any
+// native subhook can't build a trampoline for.  `AMX_TABLE` patches no code at
+// all, it replaces the native's entry in each script's native table, so only
+// calls from Pawn are hooked.  Define `PAWN_HOOK_BACKEND` before including
+// this file to change it, the same in every file that does (most simply with
+// a compiler flag for the whole plugin).
+#define PAWN_HOOK_BACKEND_SUBHOOK    1
+#define PAWN_HOOK_BACKEND_TRAMPOLINE 2
+#define PAWN_HOOK_BACKEND_AMX_TABLE  3
+
+#ifndef PAWN_HOOK_BACKEND
+	#define PAWN_HOOK_BACKEND PAWN_HOOK_BACKEND_TRAMPOLINE
+#endif
+
 namespace pawn_natives
 {
 	void Load(void **ppData);
+	int AmxLoad(AMX * amx);
+	int AmxUnload(AMX * amx);
+
+#if PAWN_HOOK_BACKEND == PAWN_HOOK_BACKEND_AMX_TABLE
+	// The native table entries replaced in a script, and what they were.  The
+	// same native may be a different function in each script (another plugin
+	// may have replaced it in some), so each keeps its own originals.
+	struct PawnHooksSwapped
+	{
+		std::vector<std::pair<ucell *, ucell>>
+			entries;
+
+		// By hook ID, `NULL` for natives the script doesn't have.
+		std::vector<AMX_NATIVE>
+			originals;
+	};
+#endif
 
 	class NativeHookBase
 	{
@@ -25,20 +63,67 @@ namespace pawn_natives
 
 		void Enable()
 		{
-			hook_.Install();
+			if (table_)
+				disabled_ = false;
+			else
+				hook_.Install();
 		}
 
 		void Disable()
 		{
-			hook_.Remove();
+			if (table_)
+				disabled_ = true;
+			else
+				hook_.Remove();
 		}
 
 		bool IsEnabled() const
 		{
+			if (table_)
+				return !disabled_;
 			return hook_.IsInstalled();
 		}
 
 	protected:
+		// While one of these exists, calls to the native go to the original
+		// code instead of back in to the hook.
+		class ScopedBypass
+		{
+		public:
+			explicit ScopedBypass(NativeHookBase & hook)
+			:
+				hook_(&hook),
+				bypassed_(hook.Bypass())
+			{
+			}
+
+			ScopedBypass(ScopedBypass && that)
+			:
+				hook_(that.hook_),
+				bypassed_(that.bypassed_)
+			{
+				that.bypassed_ = false;
+			}
+
+			~ScopedBypass()
+			{
+				if (bypassed_)
+					hook_->Restore();
+			}
+
+		private:
+			ScopedBypass() = delete;
+			ScopedBypass(ScopedBypass const &) = delete;
+			ScopedBypass & operator=(ScopedBypass const &) = delete;
+			ScopedBypass & operator=(ScopedBypass &&) = delete;
+
+			NativeHookBase *
+				hook_;
+
+			bool
+				bypassed_;
+		};
+
 		bool Recursing()
 		{
 			// Get if we are already in the native, and then flip it.
@@ -54,14 +139,23 @@ namespace pawn_natives
 			name_(name),
 			replacement_(replacement),
 			hook_(),
-			amx_(0),
-			params_(0),
+			trampoline_(0),
+			id_(ids_++),
+			bypass_(0),
+			table_(false),
+			disabled_(false),
 			recursing_(false)
+#ifdef PAWN_NATIVES_PROFILE
+			,
+			profile_(name)
+#endif
+			,
+			next_(all_)
 		{
-			if (!all_)
-				all_ = new std::list<NativeHookBase *>();
-			if (all_)
-				all_->push_back(this);
+			// Constructed during static initialisation, but `all_` is
+			// zero-initialised before any of that, so no allocation and no
+			// dependence on the order files are initialised in.
+			all_ = this;
 		}
 
 		~NativeHookBase() = default;
@@ -69,26 +163,66 @@ namespace pawn_natives
 		subhook::Hook const & GetHook() const { return hook_; }
 		subhook::Hook & GetHook() { return hook_; }
 
-		AMX * GetAMX() const { return amx_; }
-		cell * GetParams() const { return params_; }
+		// The script and parameters of the innermost call from Pawn on this
+		// thread, or `NULL` outside of one.
+		AMX * GetAMX() const
+		{
+			NativeFrame const *
+				frame = NativeFrame::Find(this);
+			return frame ? frame->GetAMX() : 0;
+		}
+
+		cell * GetParams() const
+		{
+			NativeFrame const *
+				frame = NativeFrame::Find(this);
+			return frame ? frame->GetParams() : 0;
+		}
+
+		// Call the original native directly.  This is for natives that have no
+		// typed sampgdk function to call instead, such as ones from other
+		// plugins hooked through the AMX native table.  With `SUBHOOK` this is
+		// only valid from within the hook, while the hook is removed.
+		cell CallOriginal(AMX * amx, cell * params) const
+		{
+			AMX_NATIVE
+				original = GetOriginal(amx);
+			return original ? original(amx, params) : 0;
+		}
 		
 		cell CallDoOuter(AMX * amx, cell * params)
+		{
+			return CallDoOuter(amx, params, [this](AMX * amx, cell * params) { return this->CallDoInner(amx, params); });
+		}
+
+		// The same, but with the inner call given directly instead of through
+		// the virtual `CallDoInner`, so all of it can be inlined.
+		template <typename F>
+		cell CallDoOuter(AMX * amx, cell * params, F const & inner)
 		{
 			cell
 				ret = 0;
 			if (amx && params)
 			{
+				// The hook is being bypassed, but was left installed, so the
+				// original has to be called from here instead.
+				if (bypass_ || disabled_)
+					return CallOriginal(amx, params);
+#ifdef PAWN_NATIVES_PROFILE
+				NativeProfile::Scope
+					timer(profile_);
+#endif
+				NativeFrame
+					frame(this, amx, params);
 				// Check that there are enough parameters.
-				amx_ = amx;
-				params_ = params;
 				recursing_ = true;
 				try
 				{
 					if (count_ > (unsigned int)params[0])
 						throw std::invalid_argument("Insufficient arguments.");
-					subhook::ScopedHookRemove
-						undo(&hook_);
-					ret = this->CallDoInner(amx, params);
+					ScopedBypass
+						undo(*this);
+					ret = inner(amx, params);
 				}
 				catch (std::exception & e)
 				{
@@ -104,21 +238,61 @@ namespace pawn_natives
 					sprintf(msg, "Unknown exception in in %s", name_);
 					LOG_NATIVE_ERROR(msg);
 					recursing_ = false;
-					params_ = 0;
-					amx_ = 0;
 					throw;
 				}
 				recursing_ = false;
-				params_ = 0;
-				amx_ = 0;
 			}
 			return (cell)ret;
 		}
 
+		// Call a hook's `Do` through its exact type, which is `final`, so the
+		// call isn't virtual.  Each hook class makes this base a friend.
+		template <class T, typename ... AS>
+		static decltype(auto) CallDo(T const * that, AS & ... args)
+		{
+			return that->Do(args ...);
+		}
+
 	private:
 		virtual cell CallDoInner(AMX *, cell *) = 0;
 
+		AMX_NATIVE GetOriginal([[maybe_unused]] AMX * amx) const
+		{
+#if PAWN_HOOK_BACKEND == PAWN_HOOK_BACKEND_AMX_TABLE
+			// Whatever this script's own table pointed at.
+			NativeScript *
+				script = NativeScript::Find(amx);
+			PawnHooksSwapped *
+				swapped = script ? script->Find<PawnHooksSwapped>() : 0;
+			return swapped && id_ < swapped->originals.size() ? swapped->originals[id_] : 0;
+#else
+			return trampoline_ ? trampoline_ : (AMX_NATIVE)hook_.GetSrc();
+#endif
+		}
+
+		bool Bypass()
+		{
+			// With a trampoline or the AMX table the hook stays in place and
+			// `CallDoOuter` forwards to the original, otherwise the hook is
+			// removed.
+			if (trampoline_ || table_)
+			{
+				++bypass_;
+				return true;
+			}
+			return hook_.Remove();
+		}
+
+		void Restore()
+		{
+			if (trampoline_ || table_)
+				--bypass_;
+			else
+				hook_.Install();
+		}
+
 		friend int AmxLoad(AMX * amx);
+		friend int AmxUnload(AMX * amx);
 
 		NativeHookBase() = delete;
 		NativeHookBase(NativeHookBase const &) = delete;
@@ -138,17 +312,39 @@ namespace pawn_natives
 		subhook::Hook
 			hook_;
 
-		AMX *
-			amx_;
+		// Where to jump to run the original native's code, from subhook.
+		AMX_NATIVE
+			trampoline_;
+
+		// Where this hook's original is in each script's `PawnHooksSwapped`.
+		size_t const
+			id_;
+
+		int
+			bypass_;
+
+		bool
+			table_;
 
-		cell *
-			params_;
+		bool
+			disabled_;
 
 		bool
 			recursing_;
 
-		static std::list<NativeHookBase *> *
+#ifdef PAWN_NATIVES_PROFILE
+		NativeProfile
+			profile_;
+#endif
+
+		NativeHookBase * const
+			next_;
+
+		static NativeHookBase *
 			all_;
+
+		static size_t
+			ids_;
 	};
 
 	template <typename FUNC_TYPE>
@@ -169,32 +365,18 @@ namespace pawn_natives
 				return original_();
 			}
 
-			~ScopedCall()
-			{
-				if (removed_)
-					hook_.Install();
-			}
-
 		private:
-			ScopedCall(subhook::Hook & hook, implementation_t original)
+			ScopedCall(NativeHookBase & hook, implementation_t original)
 				:
-				hook_(hook),
-				original_(original),
-				removed_(hook.Remove())
+				bypass_(hook),
+				original_(original)
 			{
 			}
 
-			ScopedCall(ScopedCall const &) = default;
-			ScopedCall & operator=(ScopedCall const &) = default;
+			ScopedCall(ScopedCall const &) = delete;
+			ScopedCall & operator=(ScopedCall const &) = delete;
 
-			ScopedCall(ScopedCall && that)
-				:
-				hook_(that.hook_),
-				original_(that.original_),
-				removed_(that.removed_)
-			{
-				that.removed_ = false;
-			}
+			ScopedCall(ScopedCall && that) = default;
 
 			ScopedCall & operator=(ScopedCall const &&) = delete;
 
@@ -202,14 +384,11 @@ namespace pawn_natives
 
 			friend class NativeHook0<RET>;
 
-			subhook::Hook &
-				hook_;
+			NativeHookBase::ScopedBypass
+				bypass_;
 
 			implementation_t const
 				original_;
-
-			bool
-				removed_;
 		};
 
 		inline RET operator()()
@@ -218,8 +397,8 @@ namespace pawn_natives
 				ret;
 			if (Recursing())
 			{
-				subhook::ScopedHookRemove
-					undo(&GetHook());
+				ScopedBypass
+					undo(*this);
 				ret = original_();
 			}
 			else
@@ -233,7 +412,7 @@ namespace pawn_natives
 		ScopedCall operator*()
 		{
 			ScopedCall
-				ret(GetHook(), original_);
+				ret(*this, original_);
 			return ret;
 		}
 
@@ -241,12 +420,24 @@ namespace pawn_natives
 		NativeHook0(char const * const name, implementation_t original, AMX_NATIVE replacement) : NativeHookBase(0, name, replacement), original_(original) {}
 		~NativeHook0() = default;
 
+		// Called from the hook's own `Call`, which knows the exact type.
+		template <class T>
+		cell CallStatic(AMX * amx, cell * params)
+		{
+			return CallDoOuter(amx, params, [this](AMX *, cell *)
+			{
+				RET
+					ret = NativeHookBase::CallDo(static_cast<T const *>(this));
+				return ReturnCast<RET>::Get(ret);
+			});
+		}
+
 	private:
 		cell CallDoInner(AMX *, cell *)
 		{
 			RET
 				ret = this->Do();
-			return *(cell *)&ret;
+			return ReturnCast<RET>::Get(ret);
 		}
 
 		virtual RET Do() const = 0;
@@ -270,32 +461,18 @@ namespace pawn_natives
 				original_();
 			}
 
-			~ScopedCall()
-			{
-				if (removed_)
-					hook_.Install();
-			}
-
 		private:
-			ScopedCall(subhook::Hook & hook, implementation_t original)
+			ScopedCall(NativeHookBase & hook, implementation_t original)
 				:
-				hook_(hook),
-				original_(original),
-				removed_(hook.Remove())
+				bypass_(hook),
+				original_(original)
 			{
 			}
 
-			ScopedCall(ScopedCall const &) = default;
-			ScopedCall & operator=(ScopedCall const &) = default;
+			ScopedCall(ScopedCall const &) = delete;
+			ScopedCall & operator=(ScopedCall const &) = delete;
 
-			ScopedCall(ScopedCall && that)
-				:
-				hook_(that.hook_),
-				original_(that.original_),
-				removed_(that.removed_)
-			{
-				that.removed_ = false;
-			}
+			ScopedCall(ScopedCall && that) = default;
 
 			ScopedCall & operator=(ScopedCall const &&) = delete;
 
@@ -303,22 +480,19 @@ namespace pawn_natives
 
 			friend class NativeHook0<void>;
 
-			subhook::Hook &
-				hook_;
+			NativeHookBase::ScopedBypass
+				bypass_;
 
 			implementation_t const
 				original_;
-
-			bool
-				removed_;
 		};
 
 		inline void operator()()
 		{
 			if (Recursing())
 			{
-				subhook::ScopedHookRemove
-					undo(&GetHook());
+				ScopedBypass
+					undo(*this);
 				original_();
 			}
 			else
@@ -331,7 +505,7 @@ namespace pawn_natives
 		ScopedCall operator*()
 		{
 			ScopedCall
-				ret(GetHook(), original_);
+				ret(*this, original_);
 			return ret;
 		}
 
@@ -339,6 +513,16 @@ namespace pawn_natives
 		NativeHook0(char const * const name, implementation_t original, AMX_NATIVE replacement) : NativeHookBase(0, name, replacement), original_(original) {}
 		~NativeHook0() = default;
 
+		template <class T>
+		cell CallStatic(AMX * amx, cell * params)
+		{
+			return CallDoOuter(amx, params, [this](AMX *, cell *)
+			{
+				NativeHookBase::CallDo(static_cast<T const *>(this));
+				return (cell)1;
+			});
+		}
+
 	private:
 		cell CallDoInner(AMX *, cell *)
 		{
@@ -359,8 +543,8 @@ namespace pawn_natives
 #if defined PAWN_NATIVES_STORAGE
 namespace pawn_natives
 {
-	std::list<NativeHookBase *> *
-		NativeHookBase::all_;
+	NativeHookBase *
+		NativeHookBase::all_ = 0;
 
 	void Load(void **ppData)
 	{
@@ -610,7 +794,7 @@ namespace pawn_natives
 	                                                                            \
 	namespace nspace                                                            \
 	{                                                                           \
-	    class Native_##nspace##_##func :                                        \
+	    class Native_##nspace##_##func final :                                  \
 	        public pawn_natives::NativeHook<type>                               \
 	    {                                                                       \
 	    public:                                                                 \
@@ -620,6 +804,8 @@ namespace pawn_natives
 	        using NativeHookBase::IsEnabled;                                    \
 	                                                                            \
 	    private:                                                                \
+	        friend class pawn_natives::NativeHookBase;                          \
+	                                                                            \
 	        friend PAWN_NATIVE_DLLEXPORT PAWN_NATIVE__RETURN(type) PAWN_NATIVE_API\
 	            ::PAWN_NATIVE_##nspace##_##func(PAWN_NATIVE__NAMED(type));      \
 	                                                                            \
@@ -643,7 +829,7 @@ namespace pawn_natives
 	cell AMX_NATIVE_CALL                                                        \
 	    nspace::Native_##nspace##_##func::Call(AMX * amx, cell * params)        \
 	{                                                                           \
-	    return ::nspace::func.CallDoOuter(amx, params);                         \
+	    return ::nspace::func.CallStatic<Native_##nspace##_##func>(amx, params); \
 	}                                                                           \
 	                                                                            \
 	PAWN_NATIVE_EXPORT PAWN_NATIVE__RETURN(type) PAWN_NATIVE_API                \
@@ -692,7 +878,7 @@ PAWN_HOOK_DEFN(fixes, SetPlayerPos, bool(int playerid, float x, float y, float z
 	// Implementation here...
 	gLastX[playerid] = x;
 	gLastY[playerid] = y;
-	// No need to worry about hooks for this function - they are removed while
+	// No need to worry about hooks for this function - they are bypassed while
 	// the hook is running.
 	return SetPlayerPos(playerid, x, y, z);
 }
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstdlib>
+#include <new>
 #include <stdexcept>
 #include <amx/amx.h>
 #include <limits>
 
+#include "Internal/NativeErrors.hpp"
+#include "Internal/NativeString.hpp"
+
 #if defined __cplusplus
 	#define PAWN_NATIVE_EXTERN extern "C"
 #else
@@ -57,41 +62,239 @@ namespace pawn_natives
 
 	typedef struct varargs_s
 	{
+		// The addresses of the arguments, as `Params[i]`.  Each is only looked
+		// up the first time it is used, and there is no allocation unless there
+		// are more than `Inline` of them.
+		class Addresses
+		{
+		public:
+			static constexpr int Inline = 16;
+
+			cell *& operator[](int i) const
+			{
+				cell *&
+					ret = list_[i];
+				if (!ret && src_)
+					amx_GetAddr(amx_, src_[i], &ret);
+				return ret;
+			}
+
+			// All of them at once, for code wanting a plain array.
+			operator cell ** () const
+			{
+				for (int i = 0; i != count_; ++i)
+					(*this)[i];
+				return list_;
+			}
+
+		private:
+			Addresses(int count, AMX * amx, cell * src)
+			:
+				list_(count > Inline ? (cell **)malloc(count * sizeof (cell *)) : inline_),
+				amx_(amx),
+				src_(src),
+				count_(count)
+			{
+				if (!list_)
+					throw std::bad_alloc();
+				for (int i = 0; i != count; ++i)
+					list_[i] = 0;
+			}
+
+			~Addresses()
+			{
+				if (list_ != inline_)
+					free(list_);
+			}
+
+			Addresses(Addresses const &) = delete;
+			Addresses & operator=(Addresses const &) = delete;
+
+			friend struct varargs_s;
+
+			mutable cell *
+				inline_[Inline];
+
+			cell ** const
+				list_;
+
+			AMX * const
+				amx_;
+
+			cell * const
+				src_;
+
+			int const
+				count_;
+		};
+
 		explicit varargs_s(int num)
 		:
 			Count(num),
-			Params((cell **)malloc(Count * sizeof (cell *)))
+			Params(num, 0, 0)
 		{
 			// This is used as "..." - instead of passing actual varargs, which
 			// could be complex.
-			if (!Params)
-				throw std::bad_alloc();
 		}
 
 		varargs_s(AMX * amx, cell * params, int idx)
 		:
 			Count((int)params[0] / sizeof (cell) - idx + 1),
-			Params((cell **)malloc(Count * sizeof (cell *)))
+			Params(Count, amx, params + idx)
 		{
 			// This is used as "..." - instead of passing actual varargs, which
 			// could be complex.
-			if (!Params)
-				throw std::bad_alloc();
-			for (int i = 0; i != Count; ++i)
-			{
-				amx_GetAddr(amx, params[idx + i], Params + i);
-			}
 		}
 
-		~varargs_s()
+		class Argument;
+		class const_iterator;
+
+		// The `i`th argument as a `T`, converted the same way as a normal
+		// parameter of that type.  Only the address is looked up and it is kept
+		// for next time, so reading the same argument twice costs nothing extra.
+		// An address outside the script throws `ParamCastFailure`, so the
+		// native is skipped and returns `0`.
+		template <typename T>
+		T Get(int i) const
+		{
+			return (T)*Value(i);
+		}
+
+		// The `i`th argument as a string, read in place.
+		AmxStringView GetString(int i) const
+		{
+			return AmxStringView(At(i));
+		}
+
+		const_iterator begin() const;
+		const_iterator end() const;
+
+		int       const Count;
+		Addresses const Params;
+
+	private:
+		cell * At(int i) const
 		{
-			free(Params);
+			if (i < 0 || i >= Count)
+				throw std::out_of_range("Not enough variable arguments.");
+			return Params[i];
 		}
 
-		int     const Count;
-		cell ** const Params;
+		cell * Value(int i) const
+		{
+			cell *
+				ret = At(i);
+			if (!ret)
+				throw ParamCastFailure();
+			return ret;
+		}
 	} * varargs_t;
 
+	template <>
+	inline float varargs_s::Get<float>(int i) const
+	{
+		return amx_ctof(*Value(i));
+	}
+
+	template <>
+	inline bool varargs_s::Get<bool>(int i) const
+	{
+		return *Value(i) != 0;
+	}
+
+	template <>
+	inline cell * varargs_s::Get<cell *>(int i) const
+	{
+		return At(i);
+	}
+
+	template <>
+	inline AmxStringView varargs_s::Get<AmxStringView>(int i) const
+	{
+		return GetString(i);
+	}
+
+	template <>
+	inline std::string varargs_s::Get<std::string>(int i) const
+	{
+		return GetString(i).str();
+	}
+
+	// One argument, from iterating over `varargs_t`:
+	//
+	//   for (auto arg : *args)
+	//       total += arg.Get<float>();
+	//
+	class varargs_s::Argument
+	{
+	public:
+		template <typename T>
+		T Get() const
+		{
+			return args_->Get<T>(index_);
+		}
+
+		AmxStringView GetString() const
+		{
+			return args_->GetString(index_);
+		}
+
+		int GetIndex() const
+		{
+			return index_;
+		}
+
+	private:
+		Argument(varargs_s const * args, int index) : args_(args), index_(index) {}
+
+		friend class varargs_s::const_iterator;
+
+		varargs_s const *
+			args_;
+
+		int
+			index_;
+	};
+
+	class varargs_s::const_iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef varargs_s::Argument value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef varargs_s::Argument const * pointer;
+		typedef varargs_s::Argument reference;
+
+		varargs_s::Argument operator*() const { return varargs_s::Argument(args_, index_); }
+
+		const_iterator & operator++() { ++index_; return *this; }
+		const_iterator operator++(int) { const_iterator ret = *this; ++index_; return ret; }
+
+		bool operator==(const_iterator const & that) const { return index_ == that.index_; }
+		bool operator!=(const_iterator const & that) const { return index_ != that.index_; }
+
+	private:
+		const_iterator(varargs_s const * args, int index) : args_(args), index_(index) {}
+
+		friend struct varargs_s;
+
+		varargs_s const *
+			args_;
+
+		int
+			index_;
+	};
+
+	inline varargs_s::const_iterator varargs_s::begin() const
+	{
+		return const_iterator(this, 0);
+	}
+
+	inline varargs_s::const_iterator varargs_s::end() const
+	{
+		return const_iterator(this, Count);
+	}
+
 	class ID32Provider
 	{
 	public:
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include <type_traits>
+
+#include "NativeImport.hpp"
+#include "Internal/NativeCast.hpp"
+
+namespace pawn_natives
+{
+	template <typename T, int INDEX_BITS>
+	class NativePool;
+
+	// Derive pooled objects from this to give them their own ID, so they can be
+	// returned to Pawn (and to other plugins) as `ID32Provider const &`.
+	class NativePoolEntry : public ID32Provider
+	{
+	public:
+		uint32_t ID() const override
+		{
+			return id_;
+		}
+
+	private:
+		template <typename T, int INDEX_BITS>
+		friend class NativePool;
+
+		uint32_t
+			id_ = 0;
+	};
+
+	// Objects for scripts, known by 32-bit IDs.  The low `INDEX_BITS` of an ID
+	// are its slot and the rest are the slot's generation, which changes every
+	// time the slot is reused, so an old ID is never mistaken for a new object.
+	// IDs are never `0` or `-1`.  Finding an object is two array reads - its
+	// block of slots, then the slot itself, which holds the object.  Blocks are
+	// never moved or freed until the pool is, so objects never move: a `T &`
+	// (including one borrowed by a native) stays valid while other objects are
+	// made and removed, until that object itself is removed.
+	template <typename T, int INDEX_BITS = 16>
+	class NativePool
+	{
+		static_assert(INDEX_BITS > 0 && INDEX_BITS < 32, "NativePool IDs need both an index and a generation.");
+
+		template <typename V>
+		class Iterator;
+
+	public:
+		static constexpr uint32_t
+			Invalid = 0;
+
+		static constexpr uint32_t
+			MaxSize = (uint32_t)1 << INDEX_BITS;
+
+		typedef Iterator<T>
+			iterator;
+
+		typedef Iterator<T const>
+			const_iterator;
+
+		NativePool() = default;
+
+		NativePool(NativePool const &) = delete;
+		NativePool & operator=(NativePool const &) = delete;
+
+		~NativePool()
+		{
+			Clear();
+		}
+
+		// Returns the new object's ID, or `Invalid` if the pool is full.
+		template <typename ... ARGS>
+		uint32_t Emplace(ARGS && ... args)
+		{
+			if (free_.empty())
+			{
+				// The last index is never used, so `-1` is never an ID.
+				if (count_ == MaxSize - 1)
+					return Invalid;
+				if ((count_ & BlockMask) == 0)
+					blocks_.emplace_back(new Slot[BlockSize]);
+				Slot &
+					slot = At(count_);
+				slot.generation_ = FreeSlot;
+				slot.dense_ = 1;
+				free_.push_back(count_++);
+			}
+			// Reuse the oldest free slot, so the generations of any one slot go
+			// round as slowly as possible.
+			uint32_t
+				index = free_.front();
+			Slot &
+				slot = At(index);
+			// Nothing else changes until the object exists.
+			used_.reserve(used_.size() + 1);
+			T *
+				obj = new (slot.object_) T(std::forward<ARGS>(args) ...);
+			used_.push_back(index);
+			free_.pop_front();
+			slot.generation_ = slot.dense_;
+			slot.dense_ = (uint32_t)used_.size() - 1;
+			uint32_t
+				id = slot.generation_ << INDEX_BITS | index;
+			if constexpr (std::is_base_of<NativePoolEntry, T>::value)
+				static_cast<NativePoolEntry *>(obj)->id_ = id;
+			return id;
+		}
+
+		// Returns `false` if there was no such object.
+		bool Remove(uint32_t id)
+		{
+			T *
+				obj = Get(id);
+			if (!obj)
+				return false;
+			uint32_t
+				index = id & IndexMask;
+			Slot &
+				slot = At(index);
+			uint32_t
+				dense = slot.dense_,
+				last = (uint32_t)used_.size() - 1;
+			if (dense != last)
+			{
+				// Keep the list of slots in use together.  Only the list
+				// changes, not where any object is.
+				used_[dense] = used_[last];
+				At(used_[dense]).dense_ = dense;
+			}
+			used_.pop_back();
+			// A free slot holds its next generation in `dense_`.  Its own
+			// generation is wider than any ID's, so no ID matches it.
+			uint32_t
+				next = (slot.generation_ + 1) & GenerationMask;
+			slot.dense_ = next ? next : 1;
+			slot.generation_ = FreeSlot;
+			free_.push_back(index);
+			// Last, so the pool is already consistent if this uses it.
+			obj->~T();
+			return true;
+		}
+
+		// `NULL` if the ID is unknown or its object has been removed.
+		T * Get(uint32_t id)
+		{
+			uint32_t
+				index = id & IndexMask;
+			if (index >= count_)
+				return 0;
+			Slot &
+				slot = At(index);
+			if (slot.generation_ != id >> INDEX_BITS)
+				return 0;
+			return Object(slot);
+		}
+
+		T const * Get(uint32_t id) const
+		{
+			return const_cast<NativePool *>(this)->Get(id);
+		}
+
+		bool Contains(uint32_t id) const
+		{
+			return Get(id) != 0;
+		}
+
+		// The ID of an object in this pool.
+		uint32_t ID(T const & obj) const
+		{
+			Slot const &
+				slot = *reinterpret_cast<Slot const *>(reinterpret_cast<unsigned char const *>(&obj) - offsetof(Slot, object_));
+			return slot.generation_ << INDEX_BITS | used_[slot.dense_];
+		}
+
+		size_t Size() const
+		{
+			return used_.size();
+		}
+
+		bool Empty() const
+		{
+			return used_.empty();
+		}
+
+		void Clear()
+		{
+			while (!used_.empty())
+				Remove(ID(*Object(At(used_.back()))));
+		}
+
+		// Every object, in no particular order.  Removing objects while
+		// iterating skips some.
+		iterator begin() { return iterator(this, used_.data()); }
+		iterator end() { return iterator(this, used_.data() + used_.size()); }
+		const_iterator begin() const { return const_iterator(this, used_.data()); }
+		const_iterator end() const { return const_iterator(this, used_.data() + used_.size()); }
+
+	private:
+		static constexpr uint32_t
+			IndexMask = MaxSize - 1;
+
+		static constexpr uint32_t
+			GenerationMask = 0xFFFFFFFFu >> INDEX_BITS;
+
+		static constexpr uint32_t
+			FreeSlot = 0xFFFFFFFFu;
+
+		// Slots are made 256 at a time (or all at once for small pools).
+		static constexpr int
+			BlockBits = INDEX_BITS < 8 ? INDEX_BITS : 8;
+
+		static constexpr uint32_t
+			BlockSize = (uint32_t)1 << BlockBits;
+
+		static constexpr uint32_t
+			BlockMask = BlockSize - 1;
+
+		struct Slot
+		{
+			uint32_t
+				generation_;
+
+			// Where the slot is in `used_`, or the next generation when the
+			// slot is free.
+			uint32_t
+				dense_;
+
+			// Only constructed while the slot is in use.
+			alignas (T) unsigned char
+				object_[sizeof (T)];
+		};
+
+		template <typename V>
+		class Iterator
+		{
+		public:
+			typedef std::forward_iterator_tag
+				iterator_category;
+
+			typedef std::remove_const_t<V>
+				value_type;
+
+			typedef std::ptrdiff_t
+				difference_type;
+
+			typedef V *
+				pointer;
+
+			typedef V &
+				reference;
+
+			Iterator(NativePool const * pool, uint32_t const * pos)
+			:
+				pool_(pool),
+				pos_(pos)
+			{
+			}
+
+			V & operator*() const { return *pool_->Object(pool_->At(*pos_)); }
+			V * operator->() const { return pool_->Object(pool_->At(*pos_)); }
+
+			Iterator & operator++()
+			{
+				++pos_;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator
+					ret = *this;
+				++pos_;
+				return ret;
+			}
+
+			bool operator==(Iterator const & that) const { return pos_ == that.pos_; }
+			bool operator!=(Iterator const & that) const { return pos_ != that.pos_; }
+
+		private:
+			NativePool const *
+				pool_;
+
+			uint32_t const *
+				pos_;
+		};
+
+		Slot & At(uint32_t index) const
+		{
+			return blocks_[index >> BlockBits][index & BlockMask];
+		}
+
+		static T * Object(Slot & slot)
+		{
+			return std::launder(reinterpret_cast<T *>(slot.object_));
+		}
+
+		std::vector<std::unique_ptr<Slot[]>>
+			blocks_;
+
+		// How many slots have been made.
+		uint32_t
+			count_ = 0;
+
+		// The slot of every object, together for iteration.
+		std::vector<uint32_t>
+			used_;
+
+		std::deque<uint32_t>
+			free_;
+	};
+
+	// Lets natives take objects from a pool as `T &` parameters:
+	//
+	//   namespace pawn_natives
+	//   {
+	//       template <>
+	//       struct ParamLookup<Vehicle> : NativePoolLookup<Vehicle, gVehicles> {};
+	//   }
+	//
+	// A stale or unknown ID skips the native, which returns `0`.
+	template <typename T, auto & POOL>
+	struct NativePoolLookup
+	{
+		static T * Borrow(cell ref)
+		{
+			return POOL.Get((uint32_t)ref);
+		}
+	};
+}
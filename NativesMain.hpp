@@ -1,51 +1,191 @@
 #pragma once
 
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <algorithm>
+
 #include "NativeImport.hpp"
+#include "Internal/NativeFrame.hpp"
+#include "Internal/NativeScript.hpp"
 
 namespace pawn_natives
 {
+#ifdef PAWN_NATIVES_PROFILE
+	NativeProfile *
+		NativeProfile::all_ = 0;
+
+	uint64_t const
+		NativeProfile::startTicks_ = NativeProfile::Now();
+
+	std::chrono::steady_clock::time_point const
+		NativeProfile::startTime_ = std::chrono::steady_clock::now();
+#endif
+
+	thread_local NativeFrame *
+		NativeFrame::current_ = 0;
+
+	std::unordered_map<AMX *, std::unique_ptr<NativeScript>>
+		NativeScript::all_;
+
+	std::vector<NativeScript *>
+		NativeScript::order_;
+
+	NativeScript *
+		NativeScript::last_ = 0;
+
+	size_t
+		NativeScript::slots_ = 0;
+
 #ifdef PAWN_NATIVES_HAS_FUNC
-	std::list<NativeFuncBase *> *
+	NativeFuncBase *
 		NativeFuncBase::all_ = 0;
+
+	static std::unordered_map<std::string_view, AMX_NATIVE>
+		gPawnNativesIndex;
+
+	static std::vector<AMX_NATIVE_INFO>
+		gPawnNativesTable;
+
+#ifdef PAWN_NATIVES_BATCH
+	// Every native, sorted by name, so a native's ID is where it is in here.
+	static std::vector<std::pair<std::string_view, AMX_NATIVE>>
+		gPawnNativesByID;
+#endif
+#endif
+
+#ifdef PAWN_NATIVES_HAS_CALLBACK
+	NativeCallbackBase *
+		NativeCallbackBase::all_ = 0;
+
+	size_t
+		NativeCallbackBase::count_ = 0;
 #endif
 
 #ifdef PAWN_NATIVES_HAS_HOOK
 	static bool
 		gPawnNativesInit = true;
 
-	std::list<NativeHookBase *> *
+	NativeHookBase *
 		NativeHookBase::all_ = 0;
+
+	size_t
+		NativeHookBase::ids_ = 0;
+
+#if PAWN_HOOK_BACKEND == PAWN_HOOK_BACKEND_AMX_TABLE
+	static std::unordered_map<std::string_view, NativeHookBase *>
+		gPawnHooksIndex;
+#endif
 #endif
 
 	int AmxLoad(AMX * amx)
 	{
 		int
 			ret = 0;
+		// Every script is known, even if nothing here needs it yet.
+		[[maybe_unused]] NativeScript &
+			script = NativeScript::Add(amx);
 #ifdef PAWN_NATIVES_HAS_FUNC
 		if (NativeFuncBase::all_)
 		{
+			if (gPawnNativesIndex.empty())
+			{
+				// All natives are static objects, so they are all known by the
+				// time the first script is loaded.  Index them by name once.
+				for (NativeFuncBase * curFunc = NativeFuncBase::all_; curFunc; curFunc = curFunc->next_)
+				{
+					LOG_NATIVE_INFO("Registering native %s", curFunc->name_);
+					gPawnNativesIndex.emplace(curFunc->name_, curFunc->native_);
+				}
+#ifdef PAWN_NATIVES_BATCH
+				gPawnNativesByID.assign(gPawnNativesIndex.begin(), gPawnNativesIndex.end());
+				std::sort(gPawnNativesByID.begin(), gPawnNativesByID.end());
+#endif
+			}
+			// Walk the natives this script imports and only give it the ones
+			// we actually provide.  `amx_Register` still searches its table
+			// for every unresolved import, but that table is now just this
+			// script's matches rather than every native in the plugin.
+			int
+				count = 0;
+			char
+				name[sNAMEMAX + 1];
+			amx_NumNatives(amx, &count);
+			gPawnNativesTable.clear();
+			for (int i = 0; i != count; ++i)
+			{
+				if (amx_GetNative(amx, i, name) != AMX_ERR_NONE)
+					continue;
+				auto
+					found = gPawnNativesIndex.find(name);
+				if (found != gPawnNativesIndex.end())
+					gPawnNativesTable.push_back({ found->first.data(), found->second });
+			}
 			// Need a sentinel because of:
 			//   
 			//   https://github.com/Zeex/sampgdk/issues/188
 			//   
 			// Otherwise we could do:
 			//   
-			//   curNative.name = curFunc->name_;
-			//   curNative.func = curFunc->native_;
-			//   ret = amx_Register(amx, &curNative, 1);
+			//   ret = amx_Register(amx, gPawnNativesTable.data(), gPawnNativesTable.size());
 			//   
-			AMX_NATIVE_INFO
-				curNative[2] = { {0, 0}, {0, 0} };
-			for (NativeFuncBase * curFunc : *NativeFuncBase::all_)
-			{
-				LOG_NATIVE_INFO("Registering native %s", curFunc->name_);
-				curNative[0].name = curFunc->name_;
-				curNative[0].func = curFunc->native_;
-				ret = amx_Register(amx, curNative, -1);
-			}
+			// Registered even when the script uses none of ours, so the result
+			// still says whether any of its natives are missing.
+			gPawnNativesTable.push_back({ 0, 0 });
+			ret = amx_Register(amx, gPawnNativesTable.data(), -1);
 		}
 #endif
 #ifdef PAWN_NATIVES_HAS_HOOK
+#if PAWN_HOOK_BACKEND == PAWN_HOOK_BACKEND_AMX_TABLE
+		if (NativeHookBase::all_)
+		{
+			if (gPawnHooksIndex.empty())
+			{
+				for (NativeHookBase * curFunc = NativeHookBase::all_; curFunc; curFunc = curFunc->next_)
+					gPawnHooksIndex.emplace(curFunc->name_, curFunc);
+			}
+			// Point this script's own native table at the hooks.  No code is
+			// patched, so only calls made through the AMX are hooked, but this
+			// works for any native already registered in the script, even ones
+			// from other plugins.
+			int
+				count = 0;
+			char
+				name[sNAMEMAX + 1];
+			AMX_HEADER *
+				hdr = (AMX_HEADER *)amx->base;
+			PawnHooksSwapped &
+				swapped = script.Get<PawnHooksSwapped>();
+			amx_NumNatives(amx, &count);
+			for (int i = 0; i != count; ++i)
+			{
+				if (amx_GetNative(amx, i, name) != AMX_ERR_NONE)
+					continue;
+				auto
+					found = gPawnHooksIndex.find(name);
+				if (found == gPawnHooksIndex.end())
+					continue;
+				NativeHookBase *
+					curFunc = found->second;
+				AMX_FUNCSTUBNT *
+					entry = (AMX_FUNCSTUBNT *)(amx->base + hdr->natives + i * hdr->defsize);
+				if (!entry->address || entry->address == (ucell)curFunc->replacement_)
+				{
+					// Natives from plugins loaded after this one aren't
+					// registered yet.
+					LOG_NATIVE_INFO("Hooking native %s (NOT FOUND)", curFunc->name_);
+					continue;
+				}
+				LOG_NATIVE_INFO("Hooking native %s: %p -> %p", curFunc->name_, (void *)entry->address, (void *)curFunc->replacement_);
+				curFunc->table_ = true;
+				if (swapped.originals.size() <= curFunc->id_)
+					swapped.originals.resize(NativeHookBase::ids_, 0);
+				swapped.originals[curFunc->id_] = (AMX_NATIVE)entry->address;
+				swapped.entries.emplace_back(&entry->address, entry->address);
+				entry->address = (ucell)curFunc->replacement_;
+			}
+		}
+#else
 		if (gPawnNativesInit)
 		{
 			gPawnNativesInit = false;
@@ -53,13 +193,20 @@ namespace pawn_natives
 			{
 				AMX_NATIVE
 					curNative = 0;
-				for (NativeHookBase * curFunc : *NativeHookBase::all_)
+				for (NativeHookBase * curFunc = NativeHookBase::all_; curFunc; curFunc = curFunc->next_)
 				{
 					curNative = sampgdk_FindNative(curFunc->name_);
 					if (curNative)
 					{
 						LOG_NATIVE_INFO("Hooking native %s: %p -> %p", curFunc->name_, (void *)curNative, (void *)curFunc->replacement_);
 						curFunc->hook_.Install((void *)curNative, (void *)curFunc->replacement_);
+#if PAWN_HOOK_BACKEND == PAWN_HOOK_BACKEND_TRAMPOLINE
+						// Leave the hook installed and call the original
+						// through the trampoline.  This is `NULL` if subhook
+						// couldn't relocate the native's prologue, in which
+						// case the hook is removed around calls as before.
+						curFunc->trampoline_ = (AMX_NATIVE)curFunc->hook_.GetTrampoline();
+#endif
 					}
 					else
 					{
@@ -68,8 +215,119 @@ namespace pawn_natives
 				}
 			}
 		}
+#endif
+#endif
+#ifdef PAWN_NATIVES_HAS_CALLBACK
+		// Find every public we might call in this script now, so calls don't
+		// have to search for them by name.
+		for (NativeCallbackBase * curFunc = NativeCallbackBase::all_; curFunc; curFunc = curFunc->next_)
+			curFunc->Load(script);
 #endif
 		return ret;
 	}
-}
 
+	int AmxUnload(AMX * amx)
+	{
+		NativeScript *
+			script = NativeScript::Find(amx);
+		if (!script)
+			return AMX_ERR_NONE;
+#ifdef PAWN_NATIVES_HAS_HOOK
+#if PAWN_HOOK_BACKEND == PAWN_HOOK_BACKEND_AMX_TABLE
+		if (PawnHooksSwapped * swapped = script->Find<PawnHooksSwapped>())
+		{
+			// Put the original natives back.
+			for (auto const & swap : swapped->entries)
+				*swap.first = swap.second;
+		}
+#endif
+#endif
+		// Everything else kept for the script goes with it.
+		NativeScript::Remove(amx);
+		return AMX_ERR_NONE;
+	}
+
+#if defined PAWN_NATIVES_BATCH && defined PAWN_NATIVES_HAS_FUNC
+	// The ID of a native in this plugin for `CallNativeBatch`, or `-1`.  IDs
+	// only change when the plugin's natives do.
+	PAWN_NATIVE(pawn_natives, GetNativeID, int(std::string const & name))
+	{
+		auto
+			found = std::lower_bound(gPawnNativesByID.begin(), gPawnNativesByID.end(), std::string_view(name), [](std::pair<std::string_view, AMX_NATIVE> const & native, std::string_view name) { return native.first < name; });
+		if (found == gPawnNativesByID.end() || found->first != name)
+			return -1;
+		return (int)(found - gPawnNativesByID.begin());
+	}
+
+	// Calls many natives from one call from Pawn.  `buffer` holds one entry for
+	// each: the native's ID, the number of parameters, then the parameters, as
+	// they would be passed normally.  Each return value goes in `results`, if
+	// there is space.  Stops at the first bad entry, and returns how many were
+	// called.  Both arrays are checked against the script's memory before
+	// anything is called, so a wrong size or count calls nothing.
+	PAWN_NATIVE(pawn_natives, CallNativeBatch, int(AmxSpan<cell> buffer, AmxSpan<cell> results))
+	{
+		AMX *
+			amx = GetAMX();
+		int
+			size = (int)buffer.size(),
+			count = (int)results.size(),
+			done = 0;
+		for (int i = 0; i + 1 < size; ++done)
+		{
+			cell
+				id = buffer[i],
+				args = buffer[i + 1];
+			if (id < 0 || id >= (cell)gPawnNativesByID.size() || args < 0 || args > size - i - 2)
+				break;
+			// The count is in bytes in `params`, which the entry is, from here.
+			buffer[i + 1] = args * sizeof (cell);
+			cell
+				ret = gPawnNativesByID[id].second(amx, buffer.data() + i + 1);
+			buffer[i + 1] = args;
+			if (done < count)
+				results[done] = ret;
+			i += 2 + args;
+		}
+		return done;
+	}
+#endif
+
+#if defined PAWN_NATIVES_PROFILE && defined PAWN_NATIVES_HAS_FUNC
+	// Profiling results for Pawn, so scripts can find out which natives are
+	// slow without needing a debugger on the server.  Times are in
+	// microseconds.
+	PAWN_NATIVE(pawn_natives, GetNativeProfile, bool(std::string const & name, int * count, float * total, float * min, float * max))
+	{
+		NativeProfile *
+			profile = NativeProfile::Find(name.c_str());
+		if (!profile)
+			return false;
+		*count = (int)profile->GetCount();
+		*total = (float)NativeProfile::ToMicroseconds(profile->GetTotal());
+		*min = (float)NativeProfile::ToMicroseconds(profile->GetMin());
+		*max = (float)NativeProfile::ToMicroseconds(profile->GetMax());
+		return true;
+	}
+
+	// The array's size is checked against the script's memory, so a wrong
+	// `size` skips the call rather than writing past the end.
+	PAWN_NATIVE(pawn_natives, GetNativeProfileHistogram, int(std::string const & name, AmxSpan<cell> buckets))
+	{
+		NativeProfile *
+			profile = NativeProfile::Find(name.c_str());
+		if (!profile)
+			return 0;
+		int
+			size = buckets.size() < (size_t)NativeProfile::Buckets ? (int)buckets.size() : NativeProfile::Buckets;
+		for (int i = 0; i != size; ++i)
+			buckets[i] = (cell)profile->GetBucket(i);
+		return size;
+	}
+
+	PAWN_NATIVE(pawn_natives, ResetNativeProfiles, void())
+	{
+		NativeProfile::ResetAll();
+	}
+#endif
+}
@@ -0,0 +1,843 @@
+// Loads and unloads many scripts on the stand-in server, calling natives and
+// hooks from Pawn and from C++ on each one, and checks every result.  Exits
+// with the number of failures.
+//
+//   pawn-natives-load [scripts] [calls]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <memory>
+
+#include <sampgdk/interop.h>
+
+#define PAWN_NATIVES_BATCH
+
+#include "../NativeHook.hpp"
+#include "../NativeFunc.hpp"
+#include "../NativeImport.hpp"
+#include "../NativeCallback.hpp"
+#include "../NativesMain.hpp"
+#include "../NativePool.hpp"
+
+#include "StandIn.hpp"
+
+static int
+	gFailures = 0;
+
+static cell
+	gServerValue = 0;
+
+static stand_in::Script *
+	gScript = 0;
+
+struct LoadObject
+{
+	int Value;
+
+	int Add(int extra);
+};
+
+static std::shared_ptr<LoadObject>
+	gObjects[4] = { std::make_shared<LoadObject>(LoadObject{ 10 }), 0, std::make_shared<LoadObject>(LoadObject{ 30 }), 0 };
+
+namespace pawn_natives
+{
+	template <>
+	struct ParamLookup<LoadObject>
+	{
+		static std::shared_ptr<LoadObject> Ref(cell ref)
+		{
+			std::shared_ptr<LoadObject>
+				ret = TryRef(ref);
+			if (!ret)
+				throw ParamCastFailure();
+			return ret;
+		}
+
+		static std::shared_ptr<LoadObject> TryRef(cell ref)
+		{
+			if (ref < 0 || ref >= 4)
+				return 0;
+			return gObjects[ref];
+		}
+
+		static LoadObject * Borrow(cell ref)
+		{
+			if (ref < 0 || ref >= 4)
+				return 0;
+			return gObjects[ref].get();
+		}
+	};
+}
+
+struct PooledObject : pawn_natives::NativePoolEntry
+{
+	PooledObject(int value) : Value(value) {}
+
+	int Value;
+};
+
+static pawn_natives::NativePool<PooledObject>
+	gPool;
+
+namespace pawn_natives
+{
+	template <>
+	struct ParamLookup<PooledObject> : NativePoolLookup<PooledObject, gPool> {};
+}
+
+typedef pawn_natives::ID32Provider const & id;
+
+struct LoadService
+{
+	int Value;
+};
+
+static std::shared_ptr<LoadService>
+	gService = std::make_shared<LoadService>(LoadService{ 100 });
+
+static int
+	gInjections = 0;
+
+namespace pawn_natives
+{
+	template <>
+	struct ParamInject<LoadService>
+	{
+		static std::shared_ptr<LoadService> Get()
+		{
+			++gInjections;
+			return gService;
+		}
+	};
+}
+
+static int
+	gCountersFreed = 0;
+
+// Kept for each script, and counted when it is freed.
+struct LoadCounter
+{
+	~LoadCounter()
+	{
+		++gCountersFreed;
+	}
+
+	int Count = 0;
+};
+
+#define CHECK(cond) \
+	do                                                                          \
+	{                                                                           \
+	    if (!(cond))                                                            \
+	    {                                                                       \
+	        if (gFailures++ < 10)                                               \
+	            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+	    }                                                                       \
+	}                                                                           \
+	while (0)
+
+// The "server" natives.
+static cell AMX_NATIVE_CALL Server_SetValue(AMX * amx, cell * params)
+{
+	gServerValue = params[1];
+	return 1;
+}
+
+static cell AMX_NATIVE_CALL Server_GetValue(AMX * amx, cell * params)
+{
+	return gServerValue;
+}
+
+static cell AMX_NATIVE_CALL Server_ScaleValue(AMX * amx, cell * params)
+{
+	return params[1] * 2;
+}
+
+// The same native, as replaced by another plugin in some scripts only.
+static cell AMX_NATIVE_CALL Other_ScaleValue(AMX * amx, cell * params)
+{
+	return params[1] * 3;
+}
+
+// The script's public, as if it were:
+//
+//   public OnLoadEvent(value, Float:scale, const name[], const data[], size)
+//
+static cell AMX_NATIVE_CALL Public_OnLoadEvent(AMX * amx, cell * params)
+{
+	cell *
+		name;
+	cell *
+		data;
+	if (params[0] != 5 * sizeof (cell) || amx_GetAddr(amx, params[3], &name) || amx_GetAddr(amx, params[4], &data))
+		return -1;
+	int
+		len;
+	amx_StrLen(name, &len);
+	cell
+		ret = params[1] + (cell)amx_ctof(params[2]) + len;
+	for (cell i = 0; i != params[5]; ++i)
+		ret += data[i];
+	// Writes go to the script's copy, not the caller's.
+	data[0] = 1000;
+	return ret;
+}
+
+static stand_in::Script *
+	gReload[3];
+
+static int
+	gReloads = 0;
+
+// Another public, as if it were:
+//
+//   public OnReload(value)
+//
+// The first script's version unloads the second script and loads the third,
+// the way a filterscript reload would, during a call to every script.
+static cell AMX_NATIVE_CALL Public_OnReload(AMX * amx, cell * params)
+{
+	++gReloads;
+	if (amx == gReload[0]->GetAMX())
+	{
+		gReload[1]->Unload(&pawn_natives::AmxUnload);
+		gReload[2]->Load(&pawn_natives::AmxLoad);
+	}
+	return params[1];
+}
+
+// What sampgdk would generate for them.
+extern "C" bool sampgdk_SetValue(int value)
+{
+	static AMX_NATIVE
+		native = sampgdk_FindNative("SetValue");
+	cell
+		params[] = { 1 * sizeof (cell), value };
+	return sampgdk_CallNative(native, params) != 0;
+}
+
+extern "C" int sampgdk_GetValue()
+{
+	static AMX_NATIVE
+		native = sampgdk_FindNative("GetValue");
+	cell
+		params[] = { 0 };
+	return (int)sampgdk_CallNative(native, params);
+}
+
+extern "C" int sampgdk_ScaleValue(int value)
+{
+	static AMX_NATIVE
+		native = sampgdk_FindNative("ScaleValue");
+	cell
+		params[] = { 1 * sizeof (cell), value };
+	return (int)sampgdk_CallNative(native, params);
+}
+
+// The plugin.
+PAWN_NATIVE(load, AddValues, int(int a, int b))
+{
+	return a + b;
+}
+
+PAWN_NATIVE(load, CountChars, int(std::string const & str))
+{
+	return (int)str.length();
+}
+
+PAWN_NATIVE(load, IsGreeting, bool(pawn_natives::AmxStringView str))
+{
+	return str == "Hello World";
+}
+
+PAWN_NATIVE(load, GetGreeting, bool(std::string * str))
+{
+	*str = "Hello";
+	return true;
+}
+
+PAWN_NATIVE(load, GetFarewell, int(pawn_natives::AmxStringOutput str, bool write))
+{
+	if (write)
+		str = "Goodbye, and thanks for all the fish";
+	return (int)str.length();
+}
+
+PAWN_NATIVE(load, SumValues, int(pawn_natives::varargs_t args))
+{
+	int
+		ret = 0;
+	for (auto arg : *args)
+		ret += arg.Get<int>();
+	return ret;
+}
+
+PAWN_NATIVE(load, CountMatches, int(pawn_natives::AmxStringView str, pawn_natives::varargs_t args))
+{
+	int
+		ret = 0;
+	for (int i = 0; i != args->Count; ++i)
+		ret += args->GetString(i) == str;
+	return ret;
+}
+
+PAWN_NATIVE_NOEXCEPT(load, GetObjectValue, int(std::shared_ptr<LoadObject> obj, int extra))
+{
+	return obj->Value + extra;
+}
+
+// `LoadObject_Add` in Pawn.
+PAWN_METHOD(LoadObject, Add, int(int extra))
+{
+	return Value + extra;
+}
+
+PAWN_NATIVE(load, CreatePooled, id(int value))
+{
+	return *gPool.Get(gPool.Emplace(value));
+}
+
+PAWN_NATIVE(load, GetPooled, int(PooledObject & obj))
+{
+	return obj.Value;
+}
+
+PAWN_NATIVE(load, DestroyPooled, bool(PooledObject const & obj))
+{
+	return gPool.Remove(obj.ID());
+}
+
+// Makes and removes other objects while borrowing one, which mustn't move.
+PAWN_NATIVE(load, ChurnPooled, int(PooledObject & obj, int count))
+{
+	std::vector<uint32_t>
+		ids;
+	for (int i = 0; i != count; ++i)
+		ids.push_back(gPool.Emplace(i));
+	for (uint32_t id : ids)
+		gPool.Remove(id);
+	return gPool.Get(obj.ID()) == &obj ? obj.Value : -1;
+}
+
+// Strings and other references that aren't object lookups are addresses, so
+// can't be batched.
+static_assert(pawn_natives::BatchParam<PooledObject &>::value, "Pooled objects can be batched.");
+static_assert(pawn_natives::BatchParam<DI<LoadService> const &>::value, "Services can be batched.");
+static_assert(!pawn_natives::BatchParam<std::string const &>::value, "Strings can't be batched.");
+static_assert(!pawn_natives::BatchParam<pawn_natives::AmxStringView const &>::value, "Strings can't be batched.");
+
+// `AddPooledBatch` in Pawn too.  Checks it still sees its own call.
+PAWN_NATIVE_BATCH(load, AddPooled, bool(PooledObject & obj, int add))
+{
+	obj.Value += add;
+	return GetAMX() == gScript->GetAMX() && GetParams()[2] == add;
+}
+
+PAWN_NATIVE(load, SumArray, int(pawn_natives::AmxSpan<cell const> values))
+{
+	int
+		ret = 0;
+	for (cell value : values)
+		ret += value;
+	return ret;
+}
+
+// Changes the script's own array.
+PAWN_NATIVE(load, ScaleArray, int(pawn_natives::AmxSpan<float> values, float by))
+{
+	for (float & value : values)
+		value *= by;
+	return (int)values.size();
+}
+
+PAWN_NATIVE(load, GetServiceValue, int(int extra, DI<LoadService> const & svc))
+{
+	return svc->Value + extra;
+}
+
+// How often the calling script has called this.
+PAWN_NATIVE(load, CountCalls, int())
+{
+	return ++pawn_natives::NativeScript::GetCurrent()->Get<LoadCounter>().Count;
+}
+
+PAWN_CALLBACK(load, OnLoadEvent, int(int value, float scale, std::string const & name, std::vector<cell> const & data, int size));
+
+// Not in any script.
+PAWN_CALLBACK(load, OnMissing, void(int value));
+
+PAWN_CALLBACK(load, OnReload, int(int value));
+
+// Calls itself again through the script, like a native running a callback
+// that calls it, then checks that it still sees its own call.
+PAWN_NATIVE(load, Nest, int(int depth))
+{
+	int
+		ret = depth;
+	if (depth > 0)
+	{
+		cell
+			inner[] = { 1 * sizeof (cell), depth - 1 };
+		ret += (int)gScript->Call(11, inner);
+	}
+	if (GetAMX() != gScript->GetAMX() || GetParams()[1] != depth)
+		return -1000;
+	return ret;
+}
+
+// Doubles every value the server is given.
+PAWN_HOOK(load, SetValue, bool(int value))
+{
+	return SetValue(value * 2);
+}
+
+// Calls whichever function the calling script's native was.
+PAWN_HOOK(load, ScaleValue, int(int value))
+{
+	return (int)CallOriginal(GetAMX(), GetParams()) + 1;
+}
+
+// Every string kernel this CPU can run must give exactly what the plain loops
+// do: for every length up to a few vectors (so every tail size), from every
+// alignment, with every terminator position, and with cells that don't fit in
+// a `char` - above `0x7F`, above `0xFF`, and negative.
+typedef size_t (*StrLenKernel)(cell const *, size_t);
+typedef void (*NarrowKernel)(char *, cell const *, size_t);
+typedef void (*WidenKernel)(cell *, char const *, size_t);
+
+static void CheckStringKernels(StrLenKernel strLen, NarrowKernel narrow, WidenKernel widen)
+{
+	// Room for the vector loads past the end too.
+	alignas(32) cell
+		cells[160];
+	alignas(32) char
+		chars[160];
+	cell
+		wide[2][160];
+	char
+		narrowed[2][160];
+	for (int k = 0; k != 160; ++k)
+	{
+		// Never `0`, so only the terminator ends the string.
+		cells[k] = (cell)((unsigned int)(k + 1) * 0x9E3779B1u) | 0x100;
+		chars[k] = (char)(k * 37 + 11);
+	}
+	cells[5] = -1;
+	cells[6] = 0x80;
+	cells[7] = 0xFF;
+	cells[8] = -0x80;
+	for (int offset = 0; offset != 8; ++offset)
+	{
+		cell *
+			src = cells + offset;
+		for (int end = 0; end <= 80; ++end)
+		{
+			cell
+				saved = src[end];
+			src[end] = 0;
+			for (int max = 0; max <= 80; ++max)
+				CHECK(strLen(src, max) == pawn_natives::simd::StrLenScalar(src, max));
+			src[end] = saved;
+		}
+		for (int n = 0; n <= 80; ++n)
+		{
+			memset(narrowed, 0x55, sizeof (narrowed));
+			narrow(narrowed[0], src, n);
+			pawn_natives::simd::NarrowScalar(narrowed[1], src, n);
+			CHECK(memcmp(narrowed[0], narrowed[1], sizeof (narrowed[0])) == 0);
+		}
+	}
+	for (int offset = 0; offset != 32; ++offset)
+	{
+		for (int n = 0; n <= 80; ++n)
+		{
+			memset(wide, 0x55, sizeof (wide));
+			widen(wide[0] + (offset & 7), chars + offset, n);
+			pawn_natives::simd::WidenScalar(wide[1] + (offset & 7), chars + offset, n);
+			CHECK(memcmp(wide[0], wide[1], sizeof (wide[0])) == 0);
+		}
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	CheckStringKernels(&pawn_natives::StrLenCells, &pawn_natives::NarrowCells, &pawn_natives::WidenChars);
+#ifdef PAWN_NATIVES_SIMD
+	if (pawn_natives::simd::GetLevel() >= pawn_natives::simd::Level::SSE2)
+		CheckStringKernels(&pawn_natives::simd::StrLenSSE2, &pawn_natives::simd::NarrowSSE2, &pawn_natives::simd::WidenSSE2);
+	if (pawn_natives::simd::GetLevel() >= pawn_natives::simd::Level::AVX2)
+		CheckStringKernels(&pawn_natives::simd::StrLenAVX2, &pawn_natives::simd::NarrowAVX2, &pawn_natives::simd::WidenAVX2);
+#endif
+
+	int
+		scripts = argc > 1 ? atoi(argv[1]) : 1000,
+		calls = argc > 2 ? atoi(argv[2]) : 1000;
+	stand_in::AddNative("SetValue", &Server_SetValue);
+	stand_in::AddNative("GetValue", &Server_GetValue);
+	stand_in::AddNative("ScaleValue", &Server_ScaleValue);
+
+	{
+		// Using none of this plugin's natives still reports missing ones.
+		stand_in::Script
+			serverOnly({ "GetValue" }),
+			missing({ "GetValue", "NotProvided" });
+		CHECK(serverOnly.Load(&pawn_natives::AmxLoad) == AMX_ERR_NONE);
+		CHECK(missing.Load(&pawn_natives::AmxLoad) == AMX_ERR_NOTFOUND);
+		serverOnly.Unload(&pawn_natives::AmxUnload);
+		missing.Unload(&pawn_natives::AmxUnload);
+	}
+
+#if PAWN_HOOK_BACKEND == PAWN_HOOK_BACKEND_AMX_TABLE
+	{
+		// Each script's hook calls that script's own original, even after the
+		// script it was first seen in is unloaded.
+		stand_in::Script
+			first({ "ScaleValue" }),
+			second({ "ScaleValue" });
+		cell
+			scale[] = { 1 * sizeof (cell), 4 };
+		CHECK(first.Load(&pawn_natives::AmxLoad) == AMX_ERR_NONE);
+		stand_in::ClearNatives();
+		stand_in::AddNative("SetValue", &Server_SetValue);
+		stand_in::AddNative("GetValue", &Server_GetValue);
+		stand_in::AddNative("ScaleValue", &Other_ScaleValue);
+		CHECK(second.Load(&pawn_natives::AmxLoad) == AMX_ERR_NONE);
+		CHECK(first.Call(0, scale) == 4 * 2 + 1);
+		CHECK(second.Call(0, scale) == 4 * 3 + 1);
+		first.Unload(&pawn_natives::AmxUnload);
+		CHECK(first.GetNative(0) == &Server_ScaleValue);
+		CHECK(second.Call(0, scale) == 4 * 3 + 1);
+		second.Unload(&pawn_natives::AmxUnload);
+		CHECK(second.GetNative(0) == &Other_ScaleValue);
+		stand_in::ClearNatives();
+		stand_in::AddNative("SetValue", &Server_SetValue);
+		stand_in::AddNative("GetValue", &Server_GetValue);
+		stand_in::AddNative("ScaleValue", &Server_ScaleValue);
+	}
+#endif
+
+	{
+		// Scripts loaded or unloaded by a public don't upset a call to every
+		// script: the unloaded one is skipped and the new one isn't called.
+		stand_in::Script
+			first({ "GetValue" }, { { "OnReload", &Public_OnReload } }),
+			second({ "GetValue" }, { { "OnReload", &Public_OnReload } }),
+			third({ "GetValue" }, { { "OnReload", &Public_OnReload } });
+		gReload[0] = &first;
+		gReload[1] = &second;
+		gReload[2] = &third;
+		CHECK(first.Load(&pawn_natives::AmxLoad) == AMX_ERR_NONE);
+		CHECK(second.Load(&pawn_natives::AmxLoad) == AMX_ERR_NONE);
+		CHECK(load::OnReload(5) == 5);
+		CHECK(gReloads == 1);
+		CHECK(pawn_natives::NativeScript::Find(second.GetAMX()) == 0);
+		CHECK(load::OnReload.Call(third.GetAMX(), 6) == 6);
+		CHECK(gReloads == 2);
+		first.Unload(&pawn_natives::AmxUnload);
+		third.Unload(&pawn_natives::AmxUnload);
+	}
+
+	// Every call made from Pawn, counted by the stand-in server.
+	size_t
+		total = 0;
+	auto
+		start = std::chrono::steady_clock::now();
+	for (int i = 0; i != scripts; ++i)
+	{
+		stand_in::Script
+			script({ "GetValue", "AddValues", "NotProvided", "CountChars", "SetValue", "GetGreeting", "IsGreeting", "GetFarewell", "SumValues", "CountMatches", "GetObjectValue", "Nest", "LoadObject_Add", "CreatePooled", "GetPooled", "DestroyPooled", "GetServiceValue", "CountCalls", "GetNativeID", "CallNativeBatch", "AddPooled", "AddPooledBatch", "SumArray", "ScaleArray", "ChurnPooled", "GetNativeProfile", "GetNativeProfileHistogram", "ResetNativeProfiles" }, { { "OnLoadEvent", &Public_OnLoadEvent } });
+		// No plugin provides `NotProvided`, which the server would report.
+		CHECK(script.Load(&pawn_natives::AmxLoad) == AMX_ERR_NOTFOUND);
+		gScript = &script;
+		CHECK(script.GetNative(0) == &Server_GetValue);
+		CHECK(script.GetNative(1) != 0);
+		CHECK(script.GetNative(2) == 0);
+		CHECK(script.GetNative(3) != 0);
+		CHECK(script.GetNative(5) != 0);
+#if PAWN_HOOK_BACKEND == PAWN_HOOK_BACKEND_AMX_TABLE
+		// The script's own table points at the hook instead of the server.
+		CHECK(script.GetNative(4) != &Server_SetValue);
+#else
+		// The server's native itself is hooked.
+		CHECK(script.GetNative(4) == &Server_SetValue);
+#endif
+		cell
+			str = script.PushString("Hello World"),
+			packed = script.PushString("Hello World", true),
+			other = script.PushString("Hello Worle"),
+			out = script.Allot(16),
+			farewell = script.Allot(8),
+			untouched = script.PushString("Same"),
+			values[20];
+		// More than `varargs_t` holds without allocating.
+		cell
+			sum[21] = { 20 * sizeof (cell) };
+		for (int k = 0; k != 20; ++k)
+		{
+			values[k] = script.Allot(1);
+			*script.GetAddr(values[k]) = k + 1;
+			sum[k + 1] = values[k];
+		}
+		std::vector<cell>
+			data = { 1, 2, 3 };
+		// Look up the IDs the way a script would, once.
+		cell
+			addValues = script.PushString("AddValues"),
+			countCalls = script.PushString("CountCalls"),
+			missing = script.PushString("NotProvided"),
+			idParams[] = { 1 * sizeof (cell), addValues };
+		cell
+			addID = script.Call(18, idParams);
+		idParams[1] = countCalls;
+		cell
+			countID = script.Call(18, idParams);
+		idParams[1] = missing;
+		CHECK(addID >= 0 && countID >= 0 && addID != countID);
+		CHECK(script.Call(18, idParams) == -1);
+		cell
+			batch = script.Allot(13),
+			results = script.Allot(4),
+			ids = script.Allot(3),
+			adds = script.Allot(3);
+		for (int j = 0; j != calls; ++j)
+		{
+			cell
+				add[] = { 2 * sizeof (cell), i, j },
+				count[] = { 1 * sizeof (cell), str },
+				set[] = { 1 * sizeof (cell), j },
+				get[] = { 0 },
+				greet[] = { 2 * sizeof (cell), out, 16 },
+				is[] = { 1 * sizeof (cell), str },
+				isPacked[] = { 1 * sizeof (cell), packed },
+				isOther[] = { 1 * sizeof (cell), other },
+				bye[] = { 3 * sizeof (cell), farewell, 8, 1 },
+				noBye[] = { 3 * sizeof (cell), untouched, 5, 0 },
+				negativeBye[] = { 3 * sizeof (cell), farewell, -1, 1 },
+				longBye[] = { 3 * sizeof (cell), farewell, 100000, 1 },
+				sumFew[] = { 3 * sizeof (cell), values[0], values[1], values[2] },
+				sumBad[] = { 3 * sizeof (cell), values[0], -4, values[2] },
+				matches[] = { 5 * sizeof (cell), str, packed, other, str, untouched },
+				noMatches[] = { 1 * sizeof (cell), str },
+				object[] = { 2 * sizeof (cell), 2, 5 },
+				noObject[] = { 2 * sizeof (cell), 1, 5 },
+				badObject[] = { 2 * sizeof (cell), 99, 5 },
+				fewArgs[] = { 1 * sizeof (cell), 0 },
+				nest[] = { 1 * sizeof (cell), 3 };
+			CHECK(script.Call(1, add) == i + j);
+			CHECK(script.Call(3, count) == 11);
+			// From Pawn, through the hook.
+			CHECK(script.Call(4, set) == 1);
+			CHECK(script.Call(0, get) == j * 2);
+			// From C++, through the hook and straight to the server.
+			CHECK(load::SetValue(j + 1));
+			CHECK(sampgdk_GetValue() == (j + 1) * 2);
+			CHECK((*load::SetValue)(j));
+			CHECK(sampgdk_GetValue() == j);
+			CHECK(script.Call(5, greet) == 1);
+			CHECK(script.Call(6, is) == 1);
+			CHECK(script.Call(6, isPacked) == 1);
+			CHECK(script.Call(6, isOther) == 0);
+			CHECK(script.Call(7, bye) == 7);
+			CHECK(script.Call(7, noBye) == 0);
+			// Skipped, not thrown.
+			CHECK(script.Call(7, negativeBye) == 0);
+			CHECK(script.Call(7, longBye) == 0);
+			CHECK(script.Call(8, sumFew) == 6);
+			CHECK(script.Call(8, sum) == 210);
+			// An argument that isn't in the script skips the call.
+			CHECK(script.Call(8, sumBad) == 0);
+			CHECK(script.Call(9, matches) == 2);
+			CHECK(script.Call(9, noMatches) == 0);
+			CHECK(script.Call(10, object) == 35);
+			CHECK(script.Call(10, noObject) == 0);
+			CHECK(script.Call(10, badObject) == 0);
+			CHECK(script.Call(10, fewArgs) == 0);
+			CHECK(script.Call(11, nest) == 6);
+			// The same parameters as `GetObjectValue`.
+			CHECK(script.Call(12, object) == 35);
+			CHECK(script.Call(12, noObject) == 0);
+			CHECK(script.Call(12, badObject) == 0);
+			// IDs of removed objects stay invalid, even once their slots are
+			// reused.
+			cell
+				first[] = { 1 * sizeof (cell), j },
+				second[] = { 1 * sizeof (cell), j + 1 },
+				third[] = { 1 * sizeof (cell), j + 2 };
+			first[1] = script.Call(13, first);
+			second[1] = script.Call(13, second);
+			CHECK(script.Call(14, first) == j);
+			CHECK(script.Call(14, second) == j + 1);
+			CHECK(script.Call(15, first) == 1);
+			CHECK(script.Call(14, first) == 0);
+			CHECK(script.Call(14, second) == j + 1);
+			third[1] = script.Call(13, third);
+			CHECK(third[1] != first[1]);
+			CHECK(script.Call(14, first) == 0);
+			CHECK(script.Call(14, third) == j + 2);
+			CHECK(script.Call(15, second) == 1);
+			CHECK(script.Call(15, third) == 1);
+			CHECK(script.Call(15, first) == 0);
+			// Every object that still exists, in one call.
+			first[1] = j;
+			second[1] = j + 1;
+			third[1] = j + 2;
+			first[1] = script.Call(13, first);
+			second[1] = script.Call(13, second);
+			third[1] = script.Call(13, third);
+			CHECK(script.Call(15, second) == 1);
+			cell
+				batchIDs[] = { first[1], second[1], third[1] },
+				batchAdds[] = { 1, 2, 3 },
+				addOne[] = { 2 * sizeof (cell), first[1], 10 },
+				addEach[] = { 3 * sizeof (cell), ids, adds, 3 };
+			memcpy(script.GetAddr(ids), batchIDs, sizeof (batchIDs));
+			memcpy(script.GetAddr(adds), batchAdds, sizeof (batchAdds));
+			CHECK(script.Call(20, addOne) == 1);
+			CHECK(script.Call(21, addEach) == 2);
+			CHECK(script.Call(14, first) == j + 11);
+			CHECK(script.Call(14, third) == j + 5);
+			// Off the end of the heap.
+			addEach[3] = 100;
+			CHECK(script.Call(21, addEach) == 0);
+			addEach[3] = 0;
+			CHECK(script.Call(21, addEach) == 0);
+			CHECK(script.Call(14, first) == j + 11);
+			// Enough new objects to need more blocks.
+			cell
+				churn[] = { 2 * sizeof (cell), first[1], 300 };
+			CHECK(script.Call(24, churn) == j + 11);
+			int
+				seen = 0;
+			for (PooledObject const & obj : gPool)
+				seen += obj.Value;
+			CHECK(seen == j + 11 + j + 5);
+			CHECK(script.Call(15, first) == 1);
+			CHECK(script.Call(15, third) == 1);
+			CHECK(gPool.Empty());
+			// Arrays and their sizes, read and written in place.
+			float
+				scales[] = { 1.0f, 2.0f, 3.0f };
+			memcpy(script.GetAddr(adds), scales, sizeof (scales));
+			cell
+				sumArray[] = { 2 * sizeof (cell), ids, 2 },
+				scaleArray[] = { 3 * sizeof (cell), adds, 3, amx_ftoc(scales[1]) };
+			CHECK(script.Call(22, sumArray) == batchIDs[0] + batchIDs[1]);
+			CHECK(script.Call(23, scaleArray) == 3);
+			CHECK(amx_ctof(script.GetAddr(adds)[2]) == 6.0f);
+			// Off the end of the heap, nothing, and a negative size.
+			sumArray[2] = 100;
+			CHECK(script.Call(22, sumArray) == 0);
+			sumArray[2] = 0;
+			CHECK(script.Call(22, sumArray) == 0);
+			scaleArray[2] = -1;
+			CHECK(script.Call(23, scaleArray) == 0);
+			CHECK(amx_ctof(script.GetAddr(adds)[0]) == 2.0f);
+			// In to the script, with its heap and stack as they were after.
+			AMX *
+				amx = script.GetAMX();
+			cell
+				hea = amx->hea,
+				stk = amx->stk;
+			CHECK(load::OnLoadEvent.Call(amx, j, 2.5f, "Name", data, 3) == j + 2 + 4 + 6);
+			CHECK(load::OnLoadEvent(j, 2.5f, "Name", data, 3) == j + 2 + 4 + 6);
+			CHECK(data[0] == 1);
+			CHECK(amx->hea == hea && amx->stk == stk);
+			load::OnMissing(j);
+			// Also counts the calls from both batches below.
+			CHECK(script.Call(17, get) == j * 3 + 1);
+			// Three natives in one call, then a bad ID.
+			cell
+				entries[] = { addID, 2, i, j, countID, 0, addID, 2, j, 5, 9999, 0, 0 },
+				batchParams[] = { 4 * sizeof (cell), batch, 13, results, 4 };
+			memcpy(script.GetAddr(batch), entries, sizeof (entries));
+			CHECK(script.Call(19, batchParams) == 3);
+			CHECK(script.GetAddr(results)[0] == i + j);
+			CHECK(script.GetAddr(results)[1] == j * 3 + 2);
+			CHECK(script.GetAddr(results)[2] == j + 5);
+			CHECK(memcmp(script.GetAddr(batch), entries, sizeof (entries)) == 0);
+			// Too few parameters left for the last entry.
+			batchParams[2] = 9;
+			CHECK(script.Call(19, batchParams) == 2);
+			// Sizes past the end of the script's memory call nothing.
+			batchParams[2] = 100000;
+			CHECK(script.Call(19, batchParams) == 0);
+			batchParams[2] = -1;
+			CHECK(script.Call(19, batchParams) == 0);
+			batchParams[2] = 13;
+			batchParams[4] = 100000;
+			CHECK(script.Call(19, batchParams) == 0);
+			// The service is only found again once it is replaced.
+			cell
+				service[] = { 1 * sizeof (cell), j };
+			CHECK(script.Call(16, service) == gService->Value + j);
+			if (j % 100 == 99)
+			{
+				gService = std::make_shared<LoadService>(LoadService{ j });
+				pawn_natives::InjectCache<LoadService>::Reset();
+				CHECK(script.Call(16, service) == j + j);
+			}
+		}
+#ifdef PAWN_NATIVES_PROFILE
+		// A native called a known number of times, as seen from Pawn.
+		cell
+			profile = script.Allot(4),
+			buckets = script.Allot(pawn_natives::NativeProfile::Buckets),
+			none[] = { 0 },
+			addOnce[] = { 2 * sizeof (cell), 1, 2 },
+			profileParams[] = { 5 * sizeof (cell), addValues, profile, profile + 4, profile + 8, profile + 12 },
+			histogramParams[] = { 3 * sizeof (cell), addValues, buckets, pawn_natives::NativeProfile::Buckets },
+			histogramShort[] = { 3 * sizeof (cell), addValues, buckets, 2 },
+			histogramPast[] = { 3 * sizeof (cell), addValues, buckets, pawn_natives::NativeProfile::Buckets + 1 };
+		script.Call(27, none);
+		for (int k = 0; k != 10; ++k)
+			script.Call(1, addOnce);
+		CHECK(script.Call(25, profileParams) == 1);
+		cell *
+			times = script.GetAddr(profile);
+		CHECK(times[0] == 10);
+		CHECK(amx_ctof(times[2]) <= amx_ctof(times[3]));
+		CHECK(amx_ctof(times[3]) <= amx_ctof(times[1]));
+		CHECK(script.Call(26, histogramParams) == pawn_natives::NativeProfile::Buckets);
+		cell
+			bucketed = 0;
+		for (int k = 0; k != pawn_natives::NativeProfile::Buckets; ++k)
+			bucketed += script.GetAddr(buckets)[k];
+		CHECK(bucketed == 10);
+		// Shorter arrays only get the first buckets, and sizes running past
+		// the heap skip the call entirely.
+		script.GetAddr(buckets)[2] = -1;
+		CHECK(script.Call(26, histogramShort) == 2);
+		CHECK(script.GetAddr(buckets)[2] == -1);
+		CHECK(script.Call(26, histogramPast) == 0);
+		CHECK(script.GetAddr(buckets)[2] == -1);
+		pawn_natives::NativeProfile *
+			addProfile = pawn_natives::NativeProfile::Find("AddValues");
+		CHECK(addProfile && addProfile->GetCount() == 10);
+		CHECK(addProfile && addProfile->GetMin() <= addProfile->GetMax() && addProfile->GetMax() <= addProfile->GetTotal());
+		CHECK(pawn_natives::NativeProfile::Find("NotProvided") == 0);
+		script.Call(27, none);
+		CHECK(addProfile && addProfile->GetCount() == 0 && addProfile->GetBucket(0) == 0);
+#endif
+		CHECK(script.GetString(out) == "Hello");
+		CHECK(script.GetString(farewell) == "Goodbye");
+		CHECK(script.GetString(untouched) == "Same");
+		CHECK(pawn_natives::NativeScript::Find(script.GetAMX()) != 0);
+		total += script.GetCalls();
+		script.Unload(&pawn_natives::AmxUnload);
+		// Any native table entries pointed at hooks are put back.
+		CHECK(script.GetNative(4) == &Server_SetValue);
+		CHECK(script.GetNative(0) == &Server_GetValue);
+		CHECK(pawn_natives::NativeScript::Find(script.GetAMX()) == 0);
+		CHECK(pawn_natives::NativeScript::GetAll().empty());
+		CHECK(gCountersFreed == i + 1);
+	}
+	// Once at first, then after each `Reset`.
+	CHECK(gInjections == 1 + scripts * (calls / 100));
+	std::chrono::duration<double>
+		elapsed = std::chrono::steady_clock::now() - start;
+	printf("%d scripts, %llu calls, %.3fs, %d failures\n", scripts, (unsigned long long)total, elapsed.count(), gFailures);
+	return gFailures;
+}
@@ -0,0 +1,458 @@
+#include <cstring>
+#include <utility>
+
+#include <sampgdk/interop.h>
+
+#include "StandIn.hpp"
+
+namespace stand_in
+{
+	static std::vector<std::pair<std::string, AMX_NATIVE>> & Natives()
+	{
+		static std::vector<std::pair<std::string, AMX_NATIVE>>
+			natives;
+		return natives;
+	}
+
+	void AddNative(char const * name, AMX_NATIVE func)
+	{
+		Natives().emplace_back(name, func);
+	}
+
+	void ClearNatives()
+	{
+		Natives().clear();
+	}
+
+	static AMX_FUNCSTUBNT * GetNativeTable(AMX * amx, int * count)
+	{
+		AMX_HEADER *
+			hdr = (AMX_HEADER *)amx->base;
+		*count = (hdr->libraries - hdr->natives) / hdr->defsize;
+		return (AMX_FUNCSTUBNT *)(amx->base + hdr->natives);
+	}
+
+	static AMX_FUNCSTUBNT * GetPublicTable(AMX * amx, int * count)
+	{
+		AMX_HEADER *
+			hdr = (AMX_HEADER *)amx->base;
+		*count = (hdr->natives - hdr->publics) / hdr->defsize;
+		return (AMX_FUNCSTUBNT *)(amx->base + hdr->publics);
+	}
+
+	Script::Script(std::vector<std::string> const & natives, int dataSize)
+	:
+		Script(natives, {}, dataSize)
+	{
+	}
+
+	Script::Script(std::vector<std::string> const & natives, std::vector<std::pair<std::string, Public>> const & publics, int dataSize)
+	:
+		calls_(0)
+	{
+		// Header, then the public and native tables, then the names, then the
+		// data.
+		size_t
+			publics_ofs = sizeof (AMX_HEADER),
+			natives_ofs = publics_ofs + publics.size() * sizeof (AMX_FUNCSTUBNT),
+			names_ofs = natives_ofs + natives.size() * sizeof (AMX_FUNCSTUBNT),
+			names_size = 0;
+		for (auto const & pub : publics)
+			names_size += pub.first.length() + 1;
+		for (std::string const & name : natives)
+			names_size += name.length() + 1;
+		size_t
+			data_ofs = (names_ofs + names_size + 15) & ~(size_t)15;
+		image_.assign(data_ofs + dataSize, 0);
+		AMX_HEADER *
+			hdr = (AMX_HEADER *)image_.data();
+		hdr->size = (int32_t)image_.size();
+		hdr->magic = AMX_MAGIC;
+		hdr->defsize = sizeof (AMX_FUNCSTUBNT);
+		hdr->publics = (int32_t)publics_ofs;
+		hdr->natives = (int32_t)natives_ofs;
+		hdr->libraries = (int32_t)names_ofs;
+		hdr->pubvars = (int32_t)names_ofs;
+		hdr->tags = (int32_t)names_ofs;
+		hdr->nametable = (int32_t)names_ofs;
+		hdr->cod = (int32_t)data_ofs;
+		hdr->dat = (int32_t)data_ofs;
+		hdr->hea = 0;
+		hdr->stp = dataSize;
+		AMX_FUNCSTUBNT *
+			entry = (AMX_FUNCSTUBNT *)(image_.data() + publics_ofs);
+		size_t
+			name_ofs = names_ofs;
+		// There is no code to point at, so the "address" is the function.
+		for (auto const & pub : publics)
+		{
+			entry->address = (ucell)pub.second;
+			entry->nameofs = (uint32_t)name_ofs;
+			memcpy(image_.data() + name_ofs, pub.first.c_str(), pub.first.length() + 1);
+			name_ofs += pub.first.length() + 1;
+			++entry;
+		}
+		for (std::string const & name : natives)
+		{
+			entry->address = 0;
+			entry->nameofs = (uint32_t)name_ofs;
+			memcpy(image_.data() + name_ofs, name.c_str(), name.length() + 1);
+			name_ofs += name.length() + 1;
+			++entry;
+		}
+		memset(&amx_, 0, sizeof (amx_));
+		amx_.base = image_.data();
+		amx_.hlw = amx_.hea = 0;
+		amx_.stk = amx_.stp = dataSize;
+	}
+
+	int Script::Load(int (*amxLoad)(AMX *))
+	{
+		std::vector<AMX_NATIVE_INFO>
+			list;
+		for (auto const & native : Natives())
+			list.push_back({ native.first.c_str(), native.second });
+		list.push_back({ 0, 0 });
+		// Like the server, don't care if some are missing - they may come from
+		// plugins.
+		amx_Register(&amx_, list.data(), -1);
+		return amxLoad ? amxLoad(&amx_) : AMX_ERR_NONE;
+	}
+
+	int Script::Unload(int (*amxUnload)(AMX *))
+	{
+		return amxUnload ? amxUnload(&amx_) : AMX_ERR_NONE;
+	}
+
+	AMX_NATIVE Script::GetNative(int index) const
+	{
+		int
+			count;
+		AMX_FUNCSTUBNT *
+			natives = GetNativeTable(const_cast<AMX *>(&amx_), &count);
+		if (index < 0 || index >= count)
+			return 0;
+		return (AMX_NATIVE)natives[index].address;
+	}
+
+	void Script::Unbind()
+	{
+		int
+			count;
+		AMX_FUNCSTUBNT *
+			natives = GetNativeTable(&amx_, &count);
+		for (int i = 0; i != count; ++i)
+			natives[i].address = 0;
+	}
+
+	cell Script::Allot(int cells)
+	{
+		cell
+			ret = amx_.hea;
+		amx_.hea += cells * sizeof (cell);
+		return ret;
+	}
+
+	void Script::Release(cell addr)
+	{
+		if (addr >= amx_.hlw && addr < amx_.hea)
+			amx_.hea = addr;
+	}
+
+	cell * Script::GetAddr(cell addr)
+	{
+		cell *
+			ret = 0;
+		amx_GetAddr(&amx_, addr, &ret);
+		return ret;
+	}
+
+	cell Script::PushString(char const * str, bool pack)
+	{
+		size_t
+			len = strlen(str) + 1;
+		cell
+			ret = Allot(pack ? (int)((len + sizeof (cell) - 1) / sizeof (cell)) : (int)len);
+		amx_SetString(GetAddr(ret), str, pack, 0, len);
+		return ret;
+	}
+
+	std::string Script::GetString(cell addr)
+	{
+		cell *
+			src = GetAddr(addr);
+		int
+			len = 0;
+		if (!src)
+			return std::string();
+		amx_StrLen(src, &len);
+		std::string
+			ret(len, '\0');
+		amx_GetString(&ret[0], src, 0, len + 1);
+		return ret;
+	}
+}
+
+extern "C"
+{
+	int AMXAPI amx_GetAddr(AMX * amx, cell amx_addr, cell ** phys_addr)
+	{
+		AMX_HEADER *
+			hdr = (AMX_HEADER *)amx->base;
+		if (amx_addr < 0 || amx_addr >= amx->stp || (amx_addr >= amx->hea && amx_addr < amx->stk))
+			return AMX_ERR_MEMACCESS;
+		*phys_addr = (cell *)(amx->base + hdr->dat + amx_addr);
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_StrLen(cell const * cstring, int * length)
+	{
+		int
+			len = 0;
+		if ((ucell)*cstring > UNPACKEDMAX)
+		{
+			while ((cstring[len / sizeof (cell)] >> ((sizeof (cell) - 1 - len % sizeof (cell)) * 8)) & 0xFF)
+				++len;
+		}
+		else
+		{
+			while (cstring[len])
+				++len;
+		}
+		*length = len;
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_GetString(char * dest, cell const * source, int use_wchar, size_t size)
+	{
+		size_t
+			i = 0;
+		if ((ucell)*source > UNPACKEDMAX)
+		{
+			for ( ; i + 1 < size; ++i)
+			{
+				char
+					ch = (char)(source[i / sizeof (cell)] >> ((sizeof (cell) - 1 - i % sizeof (cell)) * 8));
+				if (!ch)
+					break;
+				dest[i] = ch;
+			}
+		}
+		else
+		{
+			for ( ; i + 1 < size && source[i]; ++i)
+				dest[i] = (char)source[i];
+		}
+		if (size)
+			dest[i] = '\0';
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_SetString(cell * dest, char const * source, int pack, int use_wchar, size_t size)
+	{
+		size_t
+			len = strlen(source);
+		if (len >= size)
+			len = size - 1;
+		if (pack)
+		{
+			// Big-endian bytes in each cell, like the AMX.
+			memset(dest, 0, (len / sizeof (cell) + 1) * sizeof (cell));
+			for (size_t i = 0; i != len; ++i)
+				dest[i / sizeof (cell)] |= (cell)(unsigned char)source[i] << ((sizeof (cell) - 1 - i % sizeof (cell)) * 8);
+		}
+		else
+		{
+			// Sign-extended, like the server's version.
+			for (size_t i = 0; i != len; ++i)
+				dest[i] = (cell)source[i];
+			dest[len] = 0;
+		}
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_NumNatives(AMX * amx, int * number)
+	{
+		stand_in::GetNativeTable(amx, number);
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_GetNative(AMX * amx, int index, char * funcname)
+	{
+		int
+			count;
+		AMX_FUNCSTUBNT *
+			natives = stand_in::GetNativeTable(amx, &count);
+		if (index < 0 || index >= count)
+			return AMX_ERR_INDEX;
+		strcpy(funcname, (char *)(amx->base + natives[index].nameofs));
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_NumPublics(AMX * amx, int * number)
+	{
+		stand_in::GetPublicTable(amx, number);
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_FindPublic(AMX * amx, char const * funcname, int * index)
+	{
+		int
+			count;
+		AMX_FUNCSTUBNT *
+			publics = stand_in::GetPublicTable(amx, &count);
+		for (int i = 0; i != count; ++i)
+		{
+			if (!strcmp(funcname, (char *)(amx->base + publics[i].nameofs)))
+			{
+				*index = i;
+				return AMX_ERR_NONE;
+			}
+		}
+		*index = 0x7FFFFFFF;
+		return AMX_ERR_NOTFOUND;
+	}
+
+	int AMXAPI amx_Push(AMX * amx, cell value)
+	{
+		AMX_HEADER *
+			hdr = (AMX_HEADER *)amx->base;
+		if (amx->stk - (cell)sizeof (cell) < amx->hea)
+			return AMX_ERR_STACKERR;
+		amx->stk -= sizeof (cell);
+		*(cell *)(amx->base + hdr->dat + amx->stk) = value;
+		++amx->paramcount;
+		return AMX_ERR_NONE;
+	}
+
+	// Reserve space on the heap, like `amx_Allot`.
+	static int Allot(AMX * amx, int cells, cell * amx_addr, cell ** phys_addr)
+	{
+		AMX_HEADER *
+			hdr = (AMX_HEADER *)amx->base;
+		if (amx->hea + cells * (cell)sizeof (cell) > amx->stk - (cell)sizeof (cell))
+			return AMX_ERR_MEMORY;
+		*amx_addr = amx->hea;
+		*phys_addr = (cell *)(amx->base + hdr->dat + amx->hea);
+		amx->hea += cells * sizeof (cell);
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_PushArray(AMX * amx, cell * amx_addr, cell ** phys_addr, cell const array[], int numcells)
+	{
+		cell
+			addr;
+		cell *
+			phys;
+		int
+			err = Allot(amx, numcells, &addr, &phys);
+		if (err != AMX_ERR_NONE)
+			return err;
+		if (array)
+			memcpy(phys, array, numcells * sizeof (cell));
+		if (amx_addr)
+			*amx_addr = addr;
+		if (phys_addr)
+			*phys_addr = phys;
+		return amx_Push(amx, addr);
+	}
+
+	int AMXAPI amx_PushString(AMX * amx, cell * amx_addr, cell ** phys_addr, char const * string, int pack, int use_wchar)
+	{
+		int
+			len = (int)strlen(string),
+			cells = pack ? len / (int)sizeof (cell) + 1 : len + 1;
+		cell
+			addr;
+		cell *
+			phys;
+		int
+			err = Allot(amx, cells, &addr, &phys);
+		if (err != AMX_ERR_NONE)
+			return err;
+		amx_SetString(phys, string, pack, use_wchar, len + 1);
+		if (amx_addr)
+			*amx_addr = addr;
+		if (phys_addr)
+			*phys_addr = phys;
+		return amx_Push(amx, addr);
+	}
+
+	int AMXAPI amx_Release(AMX * amx, cell amx_addr)
+	{
+		if (amx->hea > amx_addr)
+			amx->hea = amx_addr;
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_Exec(AMX * amx, cell * retval, int index)
+	{
+		int
+			count;
+		AMX_FUNCSTUBNT *
+			publics = stand_in::GetPublicTable(amx, &count);
+		int
+			pushed = amx->paramcount;
+		amx->paramcount = 0;
+		if (index < 0 || index >= count)
+		{
+			amx->stk += pushed * sizeof (cell);
+			return AMX_ERR_INDEX;
+		}
+		// The parameter count goes on last, so the stack then looks like
+		// `params` does for a native.
+		amx_Push(amx, pushed * sizeof (cell));
+		amx->paramcount = 0;
+		AMX_HEADER *
+			hdr = (AMX_HEADER *)amx->base;
+		cell
+			ret = ((stand_in::Public)publics[index].address)(amx, (cell *)(amx->base + hdr->dat + amx->stk));
+		amx->stk += (pushed + 1) * sizeof (cell);
+		if (retval)
+			*retval = ret;
+		return AMX_ERR_NONE;
+	}
+
+	int AMXAPI amx_Register(AMX * amx, AMX_NATIVE_INFO const * list, int number)
+	{
+		int
+			count,
+			err = AMX_ERR_NONE;
+		AMX_FUNCSTUBNT *
+			natives = stand_in::GetNativeTable(amx, &count);
+		for (int i = 0; i != count; ++i)
+		{
+			if (natives[i].address)
+				continue;
+			for (int j = 0; (number < 0 || j != number) && list[j].name; ++j)
+			{
+				if (!strcmp(list[j].name, (char *)(amx->base + natives[i].nameofs)))
+				{
+					natives[i].address = (ucell)list[j].func;
+					break;
+				}
+			}
+			if (!natives[i].address)
+				err = AMX_ERR_NOTFOUND;
+		}
+		return err;
+	}
+}
+
+SAMPGDK_API(AMX_NATIVE, sampgdk_FindNative(char const * name))
+{
+	for (auto const & native : stand_in::Natives())
+	{
+		if (native.first == name)
+			return native.second;
+	}
+	return 0;
+}
+
+SAMPGDK_API(cell, sampgdk_CallNative(AMX_NATIVE native, cell * params))
+{
+	// sampgdk calls natives with its own fake AMX.
+	static stand_in::Script
+		fake({});
+	return native(fake.GetAMX(), params);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+// Just enough of the server for natives and hooks to run without one.  Link
+// `pawn-natives-standin` instead of the SDK's `amxplugin.cpp` and `sampgdk`; it
+// provides the AMX functions natives use, and `sampgdk_FindNative` and
+// `sampgdk_CallNative` backed by a table of "server" natives, which are real
+// functions and so can be hooked.
+//
+// Scripts are real AMX images - header, native table, name table, and data -
+// so the AMX functions work on them the same way as the ones in the server, and
+// the AMX table hook backend can patch them.  There is no code section, so no
+// script code is ever run; publics are C++ functions, called by `amx_Exec` with
+// the arguments pushed for them.
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <amx/amx.h>
+
+namespace stand_in
+{
+	// Add a native to the "server", for `sampgdk_FindNative` and for scripts to
+	// bind to in `Script::Load`.  Add them all before loading the plugin, like
+	// a real server.
+	void AddNative(char const * name, AMX_NATIVE func);
+
+	void ClearNatives();
+
+	// A public function in a script, given its parameters the way a native is.
+	typedef cell (AMX_NATIVE_CALL * Public)(AMX * amx, cell * params);
+
+	class Script
+	{
+	public:
+		// `natives` are the natives the script imports, in order.
+		explicit Script(std::vector<std::string> const & natives, int dataSize = 64 * 1024);
+
+		// `publics` are the script's public functions, in order.
+		Script(std::vector<std::string> const & natives, std::vector<std::pair<std::string, Public>> const & publics, int dataSize = 64 * 1024);
+
+		Script(Script const &) = delete;
+		Script & operator=(Script const &) = delete;
+
+		AMX * GetAMX() { return &amx_; }
+
+		// Load the script the way the server does: bind its natives to the
+		// server's ones, then let the plugin register its own.  Returns the
+		// plugin's error code.
+		int Load(int (*amxLoad)(AMX *));
+
+		int Unload(int (*amxUnload)(AMX *));
+
+		// The function the script's `index`th native is bound to, which is what
+		// the AMX would call.
+		AMX_NATIVE GetNative(int index) const;
+
+		cell Call(int index, cell * params) { ++calls_; return GetNative(index)(&amx_, params); }
+
+		// How many times `Call` has been used, including from within natives.
+		size_t GetCalls() const { return calls_; }
+
+		// Forget all registrations, so the script can be loaded again.
+		void Unbind();
+
+		// Reserve some cells on the heap, and return their AMX address.
+		cell Allot(int cells);
+
+		// Give the heap back, down to an address returned by `Allot`.
+		void Release(cell addr);
+
+		cell * GetAddr(cell addr);
+
+		// Copy a string on to the heap, packed or unpacked.
+		cell PushString(char const * str, bool pack = false);
+
+		std::string GetString(cell addr);
+
+	private:
+		std::vector<unsigned char>
+			image_;
+
+		AMX
+			amx_;
+
+		size_t
+			calls_;
+	};
+}
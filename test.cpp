@@ -100,7 +100,7 @@ PLUGIN_EXPORT int PLUGIN_CALL AmxLoad(AMX *amx)
 UNMANGLE(AmxUnload, 4)
 PLUGIN_EXPORT int PLUGIN_CALL AmxUnload(AMX *amx)
 {
-	return AMX_ERR_NONE;
+	return pawn_natives::AmxUnload(amx);
 }
 
 UNMANGLE(ProcessTick, 0)